@@ -1,148 +1,4 @@
-﻿#include <iostream>
-#include <fstream>
-#include <vector>
-#include <sstream>
-#include <ctime>
-#include <set>
-#include <algorithm>
-using namespace std;
-
-struct Edge
-{
-	int u;
-	int v;
-	int weight;
-	bool operator<(Edge const& other) 
-	{
-		return weight < other.weight;
-	}
-};
-
-struct graphParameters
-{
-	int Vmin, Vmax;
-	int Emin, Emax;
-	int Wmin, Wmax;
-};
-
-void readData(string path, graphParameters& graph)
-{
-	ifstream inputFile(path);
-
-	if (!inputFile)
-	{
-		cerr << "Ошибка при открытии файла! \n";
-		exit(1);
-	}
-
-	inputFile >> graph.Vmin >> graph.Vmax;
-	inputFile >> graph.Emin >> graph.Emax;
-	inputFile >> graph.Wmin >> graph.Wmax;
-
-	inputFile.close();
-}
-
-void savedEdgeList(vector<Edge> edgeList, int vertices, string path)
-{
-	ofstream outFile(path);
-	if (!outFile)
-	{
-		cerr << "Ошибка при открытии файла! \n";
-		exit(1);
-	}
-
-	for (const auto& edge : edgeList)
-	{
-		outFile << edge.u << " " << edge.v << " " << edge.weight << "\n";
-		outFile << edge.v << " " << edge.u << " " << edge.weight << "\n";
-	}
-
-	outFile.close();
-}
-
-void generateGraph(int& vertices)
-{
-	string inputfilePath = "input.txt", listFile = "list.txt";
-	vector<Edge> edgeList;
-	graphParameters graph;
-
-	readData(inputfilePath, graph);
-
-	srand(time(0));
-
-	vertices = graph.Vmin + rand() % (graph.Vmax - graph.Vmin + 1);
-	int edges = graph.Emin + rand() % (graph.Emax - graph.Emin + 1);
-
-	if (edges > vertices * (vertices - 1) / 2)
-	{
-		edges = vertices * (vertices - 1) / 2;
-	}
-
-	cout << "Количество вершин: " << vertices << "\tКоличество рёбер: " << edges << endl;
-
-	set<pair<int, int>> edgeSet;
-
-	for (size_t i = 0; i < edges; i++)
-	{
-		int from = rand() % vertices;
-		int to = rand() % vertices;
-		if (from == to)
-		{
-			i--;
-			continue;
-		}
-
-		if (from > to)
-		{
-			swap(from, to);
-		}
-
-		if (edgeSet.count({ from, to }))
-		{
-			i--;
-			continue;
-		}
-
-		edgeSet.insert({ from, to });
-
-		int weight = 0;
-		weight = graph.Wmin + rand() % (graph.Wmax - graph.Wmin + 1);
-
-		edgeList.push_back({ from, to, weight });
-	}
-
-	savedEdgeList(edgeList, vertices, listFile);
-}
-
-void readEdgeList(vector<Edge>& edgeList, int& vertices, string path) 
-{
-    ifstream inFile(path);
-    if (!inFile) 
-    {
-        cerr << "Ошибка при открытии файла! \n";
-        exit(1);
-    }
-
-    string line;
-    vertices = 0; 
-
-    while (getline(inFile, line)) {
-        istringstream iss(line);
-        Edge edge;
-
-        if (!(iss >> edge.u >> edge.v >> edge.weight)) 
-        {
-            cerr << "Ошибка в формате данных в строке: " << line << "\n";
-            continue; 
-        }
-
-        edgeList.push_back(edge);
-
-        vertices = max(vertices, max(edge.u, edge.v) + 1); 
-    }
-
-    inFile.close();
-}
+﻿#include "../Кратчайшие пути/initGraph.h"
 
 void make_set(int v, vector<int>& parent, vector<int>& rank)
 {
@@ -170,49 +26,125 @@ void union_sets(int a, int b, vector<int>& parent, vector<int>& rank)
 	}
 }
 
+// Алгоритм Краскала по рёбрам, упорядоченным по весу; возвращает стоимость остова
+int kruskal(const vector<Edge>& edgeList, int vertices, vector<Edge>& result)
+{
+	int cost = 0;
+	vector<int> parent(vertices);
+	vector<int> rank(vertices);
+	for (int i = 0; i < vertices; i++)
+		make_set(i, parent, rank);
+
+	result.clear();
+	for (const Edge& e : edgeList) 
+	{
+		if (find(e.from, parent) != find(e.to, parent)) 
+		{
+			cost += e.weight;
+			result.push_back(e);
+			union_sets(e.from, e.to, parent, rank);
+		}
+	}
+	return cost;
+}
 
 int main()
 {
     setlocale(LC_ALL, "Russian");
 
+    string inputfilePath = "input.txt", edgelist = "list.txt";
+    graphParameters graph;
     vector<Edge> edgeList;
-    int vertices;
-    string edgelist = "list.txt";
+    int vertices, answer = 0, order, source;
+    bool sorted;
 
-    generateGraph(vertices);
-    readEdgeList(edgeList, vertices, edgelist);
+    // Граф генерируется по input.txt или читается из сохранённого ранее list.txt; заголовок
+    // "# sorted" в файле означает, что рёбра уже упорядочены по весу
+    cout << "Источник графа (0 - генерация по input.txt, 1 - файл list.txt): ";
+    cin >> source;
+
+    if (source)
+    {
+        graph.directed = 0;
+        graph.weighted = 1;
+        readEdgeList(edgeList, vertices, sorted, edgelist);
+        cout << "Количество вершин: " << vertices << "\tКоличество дуг: " << edgeList.size() << endl;
+    }
+    else
+    {
+        // По умолчанию рёбра генерируются сразу упорядоченными по весу; input.txt может это отключить
+        graph.sortedByWeight = 1;
+        readData(inputfilePath, graph);
+
+        // Остов ищется в неориентированном взвешенном графе без петель
+        if (graph.directed || !graph.weighted || graph.self_loops)
+        {
+            cerr << "Ошибка: нужен неориентированный взвешенный граф без петель (первая строка input.txt: 0 1 0).\n";
+            exit(1);
+        }
+
+        generateGraph(graph, edgeList, vertices);
+        cout << endl;
+        sorted = graph.sortedByWeight;
+
+        cout << "Сохранить граф в list.txt? (0 - нет, 1 - да): ";
+        cin >> answer;
+    }
+
+	cout << "Порядок вершин (0 - исходный, 1 - по убыванию степени, 2 - RCM, 3 - BFS, 4 - сравнить все): ";
+	cin >> order;
 
 	cout << "\nСписок рёбер сгенерированного графа: \n";
     for(const auto & edge : edgeList) 
 	{
-		cout << edge.u << " " << edge.v << " " << edge.weight << endl;
+		cout << edge.from << " " << edge.to << " " << edge.weight << endl;
 	}
 
-	int cost = 0;
-	vector<Edge> result;
-	vector<int> parent(vertices);
-	vector<int> rank(vertices);
-	for (int i = 0; i < vertices; i++)
-		make_set(i, parent, rank);
+	// Генератор или list.txt с заголовком "# sorted" дают рёбра уже упорядоченными по весу —
+	// тогда сортировка не нужна
+	if (!sorted)
+		sort(edgeList.begin(), edgeList.end(), [](const Edge& a, const Edge& b) { return a.weight < b.weight; });
 
-	sort(edgeList.begin(), edgeList.end());
+	// Запись в файл идёт в фоне, пока строится остов; после сортировки рёбра больше не меняются
+	future<void> saving;
+	if (answer)
+		saving = async(launch::async, [&]() { savedEdgeList(edgeList, graph.directed, graph.weighted, true, edgelist, graph.threads); });
 
-	for (Edge e : edgeList) 
+	// Перенумерация вершин делает обращения к массивам parent и rank более локальными;
+	// остов строится по копии рёбер с новыми номерами и выводится в исходных
+	int cost;
+	vector<Edge> result;
+	vertexPermutation permutation;
+	if (order == 4)
 	{
-		if (find(e.u, parent) != find(e.v, parent)) 
-		{
-			cost += e.weight;
-			result.push_back(e);
-			union_sets(e.u, e.v, parent, rank);
-		}
+		benchmarkOrders(buildCsr(edgeList, vertices, graph.directed, graph.weighted, graph.threads), graph.threads,
+			[&](const csrGraph&, const vertexPermutation& p)
+			{
+				vector<Edge> renamed = edgeList;
+				permuteEdges(renamed, p);
+				kruskal(renamed, vertices, result);
+			});
+	}
+
+	if (order >= degreeOrder && order <= bfsOrder)
+	{
+		permutation = computeOrder(buildCsr(edgeList, vertices, graph.directed, graph.weighted, graph.threads), order);
+		vector<Edge> renamed = edgeList;
+		permuteEdges(renamed, permutation);
+		cost = kruskal(renamed, vertices, result);
 	}
+	else
+		cost = kruskal(edgeList, vertices, result);
 	
 	cout << "\nМинимальная стоимость остовного дерева: " << cost << endl;
 	cout << "Минимальное остовное дерево (MST):" << endl;
 	for (const auto& edge : result) 
 	{
-		cout << edge.u << " -- " << edge.v << " [вес: " << edge.weight << "]" << endl;
+		cout << permutation.original(edge.from) << " -- " << permutation.original(edge.to) << " [вес: " << edge.weight << "]" << endl;
 	}
 
+	if (saving.valid())
+		saving.wait();
+
 	return 0;
 }
\ No newline at end of file
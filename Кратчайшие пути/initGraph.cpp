@@ -1,4 +1,49 @@
-#include "initGraph.h"
+﻿#include "initGraph.h"
+#include <sstream>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <bitset>
+#include <cstring>
+#include <climits>
+#include <charconv>
+#include <chrono>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+int threadCount(int threads)
+{
+	return threads > 0 ? threads : (int)max(1u, thread::hardware_concurrency());
+}
+
+// Выполняет body(i) для всех i из [first; last) в threads потоках
+void parallelFor(size_t first, size_t last, int threads, const function<void(size_t)>& body)
+{
+	atomic<size_t> nextIndex(first);
+	auto worker = [&]()
+	{
+		for (size_t i = nextIndex++; i < last; i = nextIndex++)
+			body(i);
+	};
+
+	vector<thread> pool;
+	for (int t = 1; t < threads; t++)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& th : pool)
+		th.join();
+}
 
 void readData(string path, graphParameters& graph)
 {
@@ -6,151 +51,2305 @@ void readData(string path, graphParameters& graph)
 
 	if (!inputFile)
 	{
-		cerr << "   ! \n";
+		cerr << "Ошибка при открытии файла! \n";
 		exit(1);
 	}
 
-	inputFile >> graph.directed >> graph.weighted >> graph.self_loops;
-	inputFile >> graph.Vmin >> graph.Vmax;
-	inputFile >> graph.Emin >> graph.Emax;
+	if (!(inputFile >> graph.directed >> graph.weighted >> graph.self_loops))
+	{
+		cerr << "Ошибка: неверный формат данных графа.\n";
+		exit(1);
+	}
+
+	if (!(inputFile >> graph.Vmin >> graph.Vmax >> graph.Emin >> graph.Emax))
+	{
+		cerr << "Ошибка: неверные параметры вершин или рёбер.\n";
+		exit(1);
+	}
 
 	if (graph.weighted)
 	{
-		inputFile >> graph.Wmin >> graph.Wmax;
+		if (!(inputFile >> graph.Wmin >> graph.Wmax))
+		{
+			cerr << "Ошибка: неверные параметры весов рёбер.\n";
+			exit(1);
+		}
+	}
+
+	// Необязательная строка: seed и число потоков. Без неё seed берётся от текущего времени
+	if (!(inputFile >> graph.seed))
+		graph.seed = (uint64_t)time(0);
+	if (!(inputFile >> graph.threads))
+		graph.threads = 0;
+
+	// Необязательная строка после seed: модель графа и, для R-MAT, вероятности a b c в процентах
+	if (!(inputFile >> graph.model))
+		graph.model = uniformModel;
+	int rmatA;
+	if (graph.model == rmatModel && inputFile >> rmatA)
+	{
+		graph.rmatA = rmatA;
+		inputFile >> graph.rmatB >> graph.rmatC;
+	}
+
+	if (graph.model < uniformModel || graph.model > grid3dModel ||
+		graph.rmatA < 0 || graph.rmatB < 0 || graph.rmatC < 0 || graph.rmatA + graph.rmatB + graph.rmatC > 100)
+	{
+		cerr << "Ошибка: неверные параметры модели графа.\n";
+		exit(1);
 	}
 
+	// Необязательное число после модели (у R-MAT — после a b c): 1 — выдать рёбра упорядоченными
+	// по весу, 0 — в порядке генерации. Без него остаётся значение, заданное программой
+	int sortedByWeight;
+	if (inputFile >> sortedByWeight)
+		graph.sortedByWeight = sortedByWeight;
+
 	inputFile.close();
 }
 
-void savedAdjacencyList(vector<Edge> edgeList, int vertices, int directed, int weighted, string path)
+vector<vector<int>> buildAdjacencyMatrix(const vector<Edge>& edgeList, int vertices, int directed, int weighted)
 {
-	ofstream outFile(path);
-	if (!outFile)
+	vector<vector<int>> adjMatrix(vertices, vector<int>(vertices, 0));
+
+	for (size_t i = 0; i < edgeList.size(); ++i)
+	{
+		const Edge& edge = edgeList[i];
+
+		// Записываем в матрицу смежности
+		adjMatrix[edge.from][edge.to] = weighted ? edge.weight : 1;  // Если граф взвешенный, записываем вес, иначе 1
+
+		// Если граф неориентированный, добавляем обратное ребро
+		if (!directed && edge.from != edge.to)
+		{
+			adjMatrix[edge.to][edge.from] = weighted ? edge.weight : 1;
+		}
+	}
+
+	return adjMatrix;
+}
+
+// Матрица смежности по CSR: для неориентированного графа обе дуги ребра уже есть в списках
+vector<vector<int>> buildAdjacencyMatrix(const csrGraph& g)
+{
+	vector<vector<int>> adjMatrix(g.vertices, vector<int>(g.vertices, 0));
+
+	for (int v = 0; v < g.vertices; v++)
+		for (uint32_t i = g.begin(v); i < g.end(v); i++)
+			adjMatrix[v][g.targets[i]] = g.weighted ? g.weights[i] : 1;
+
+	return adjMatrix;
+}
+
+csrGraph makeCsr(int vertices, int weighted, shared_ptr<csrBuffers> buffers)
+{
+	csrGraph g;
+	g.vertices = vertices;
+	g.weighted = weighted;
+	g.arcCount = buffers->targets.size();
+	g.offsets = buffers->offsets.data();
+	g.targets = buffers->targets.data();
+	g.weights = weighted ? buffers->weights.data() : nullptr;
+	g.storage = buffers;
+	return g;
+}
+
+// Построение CSR по списку рёбер. Соседи каждой вершины идут в том же порядке, что и рёбра
+// в edgeList (для неориентированного ребра i дуги from -> to и to -> from — на месте ребра i),
+// то есть так же, как при заполнении vector<vector<...>> через push_back. В несколько потоков
+// степени считаются и дуги раскладываются атомарными счётчиками, после чего дуги каждой вершины
+// упорядочиваются по номеру ребра — результат не зависит от числа потоков.
+csrGraph buildCsr(const vector<Edge>& edgeList, int vertices, int directed, int weighted, int threads)
+{
+	auto buffers = make_shared<csrBuffers>();
+	csrBuffers& g = *buffers;
+	g.offsets.assign(vertices + 1, 0);
+
+	size_t edges = edgeList.size(), arcs = 0;
+	for (const auto& edge : edgeList)
+		arcs += (!directed && edge.from != edge.to) ? 2 : 1;
+
+	if (arcs > UINT32_MAX)
 	{
-		cerr << "   ! \n";
+		cerr << "Ошибка: слишком много дуг для 32-битного CSR.\n";
 		exit(1);
 	}
 
-	vector<vector<pair<int, int>>> adjList(vertices);
+	g.targets.resize(arcs);
+	if (weighted)
+		g.weights.resize(arcs);
 
-	for (size_t i = 0; i < edgeList.size(); i++)
+	threads = threadCount(threads);
+	if (threads == 1 || edges < (1u << 16))
 	{
-		const Edge& edge = edgeList[i]; //      
+		for (const auto& edge : edgeList)
+		{
+			g.offsets[edge.from + 1]++;
+			if (!directed && edge.from != edge.to)
+				g.offsets[edge.to + 1]++;
+		}
+		for (int v = 0; v < vertices; v++)
+			g.offsets[v + 1] += g.offsets[v];
 
-		adjList[edge.from].push_back({ edge.to, edge.weight });
+		vector<uint32_t> cursor(g.offsets.begin(), g.offsets.end() - 1);
+		for (const auto& edge : edgeList)
+		{
+			uint32_t pos = cursor[edge.from]++;
+			g.targets[pos] = edge.to;
+			if (weighted) g.weights[pos] = edge.weight;
 
-		//   ,   
-		if (!directed && edge.from != edge.to)
+			if (!directed && edge.from != edge.to)
+			{
+				pos = cursor[edge.to]++;
+				g.targets[pos] = edge.from;
+				if (weighted) g.weights[pos] = edge.weight;
+			}
+		}
+		return makeCsr(vertices, weighted, buffers);
+	}
+
+	size_t chunk = (edges + threads - 1) / threads;
+	auto forChunks = [&](const function<void(size_t, size_t)>& body)
+	{
+		parallelFor(0, threads, threads, [&](size_t t) { body(t * chunk, min(edges, (t + 1) * chunk)); });
+	};
+
+	vector<atomic<uint32_t>> degree(vertices);
+	forChunks([&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
 		{
-			adjList[edge.to].push_back({ edge.from, edge.weight });
+			const Edge& edge = edgeList[i];
+			degree[edge.from].fetch_add(1, memory_order_relaxed);
+			if (!directed && edge.from != edge.to)
+				degree[edge.to].fetch_add(1, memory_order_relaxed);
 		}
+	});
+
+	for (int v = 0; v < vertices; v++)
+	{
+		g.offsets[v + 1] = g.offsets[v] + degree[v].load(memory_order_relaxed);
+		degree[v].store(g.offsets[v], memory_order_relaxed); // дальше — позиция следующей дуги вершины
 	}
 
-	for (int i = 0; i < vertices; ++i) {
-		outFile << i << ": ";
-		for (const auto& neighbor : adjList[i]) {
-			if (weighted) {
-				outFile << "(" << neighbor.first << ", " << neighbor.second << ") "; //   
-			}
-			else {
-				outFile << neighbor.first << " "; //  
+	// Дуга кодируется как 2 * номер ребра + направление, чтобы восстановить исходный порядок
+	vector<uint64_t> arcId(arcs);
+	forChunks([&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			const Edge& edge = edgeList[i];
+			arcId[degree[edge.from].fetch_add(1, memory_order_relaxed)] = 2 * (uint64_t)i;
+			if (!directed && edge.from != edge.to)
+				arcId[degree[edge.to].fetch_add(1, memory_order_relaxed)] = 2 * (uint64_t)i + 1;
+		}
+	});
+
+	parallelFor(0, threads, threads, [&](size_t t)
+	{
+		int first = (int)((long long)vertices * t / threads), last = (int)((long long)vertices * (t + 1) / threads);
+		for (int v = first; v < last; v++)
+		{
+			sort(arcId.begin() + g.offsets[v], arcId.begin() + g.offsets[v + 1]);
+			for (uint32_t pos = g.offsets[v]; pos < g.offsets[v + 1]; pos++)
+			{
+				const Edge& edge = edgeList[arcId[pos] / 2];
+				g.targets[pos] = (arcId[pos] & 1) ? edge.from : edge.to;
+				if (weighted) g.weights[pos] = edge.weight;
 			}
 		}
-		outFile << "\n\n";
+	});
+
+	return makeCsr(vertices, weighted, buffers);
+}
+
+csrGraph csrGraph::transposed() const
+{
+	auto buffers = make_shared<csrBuffers>();
+	csrBuffers& t = *buffers;
+	t.offsets.assign(vertices + 1, 0);
+	t.targets.resize(arcCount);
+	if (weighted)
+		t.weights.resize(arcCount);
+
+	for (size_t i = 0; i < arcCount; i++)
+		t.offsets[targets[i] + 1]++;
+	for (int v = 0; v < vertices; v++)
+		t.offsets[v + 1] += t.offsets[v];
+
+	vector<uint32_t> cursor(t.offsets.begin(), t.offsets.end() - 1);
+	for (int v = 0; v < vertices; v++)
+	{
+		for (uint32_t i = begin(v); i < end(v); i++)
+		{
+			uint32_t pos = cursor[targets[i]]++;
+			t.targets[pos] = v;
+			if (weighted) t.weights[pos] = weights[i];
+		}
 	}
 
-	outFile.close();
+	return makeCsr(vertices, weighted, buffers);
+}
+
+void textBuffer::put(long long value)
+{
+	char digits[24];
+	auto res = to_chars(digits, digits + sizeof(digits), value);
+	data.append(digits, res.ptr);
+}
+
+void textBuffer::writeTo(ostream& out)
+{
+	out.write(data.data(), data.size());
+	data.clear();
 }
 
-void savedAdjacencyMatrix(vector<Edge>& edgeList, int vertices, int directed, int weighted, string path)
+// Записывает count элементов (вершин, строк матрицы, рёбер) в path: участки по rangeItems
+// элементов форматируются параллельно в собственные буферы, затем буферы пишутся в файл
+// по порядку крупными блоками. В памяти одновременно не больше 4 * threads участков.
+static void writeParallel(const string& path, size_t count, size_t rangeItems, int threads, const string& header,
+	const function<void(size_t, size_t, textBuffer&)>& format)
 {
 	ofstream outFile(path);
 	if (!outFile)
 	{
-		cerr << "   ! \n";
+		cerr << "Ошибка при открытии файла! \n";
 		exit(1);
 	}
+	outFile.write(header.data(), header.size());
 
-	vector<vector<int>> adjMatrix(vertices, vector<int>(vertices, 0));
+	threads = threadCount(threads);
+	rangeItems = max<size_t>(1, rangeItems);
+	size_t ranges = (count + rangeItems - 1) / rangeItems;
+	size_t batch = (size_t)threads * 4;
+	vector<textBuffer> buffers(min(batch, ranges));
 
-	for (size_t i = 0; i < edgeList.size(); ++i)
+	for (size_t first = 0; first < ranges; first += batch)
 	{
+		size_t last = min(ranges, first + batch);
+		parallelFor(first, last, threads, [&](size_t r)
+		{
+			format(r * rangeItems, min(count, (r + 1) * rangeItems), buffers[r - first]);
+		});
+		for (size_t r = first; r < last; r++)
+			buffers[r - first].writeTo(outFile);
+	}
 
-		const Edge& edge = edgeList[i];
+	if (!outFile)
+	{
+		cerr << "Ошибка при записи файла " << path << "\n";
+		exit(1);
+	}
+	outFile.close();
+}
 
-		//    
-		adjMatrix[edge.from][edge.to] = weighted ? edge.weight : 1;  //   ,  ,  1
+// Примерно столько байт текста форматирует один поток за раз
+const size_t writeRangeBytes = 1 << 20;
 
-		//   ,   
-		if (!directed && edge.from != edge.to)
+void savedAdjacencyList(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path, int threads)
+{
+	csrGraph g = buildCsr(edgeList, vertices, directed, weighted, threads);
+	size_t rangeItems = writeRangeBytes / max<size_t>(1, g.arcs() * 10 / max(1, vertices) + 8);
+
+	writeParallel(path, vertices, rangeItems, threads, "", [&](size_t first, size_t last, textBuffer& out)
+	{
+		for (size_t i = first; i < last; i++)
 		{
-			adjMatrix[edge.to][edge.from] = weighted ? edge.weight : 1;
+			out.put((long long)i);
+			out.put(": ");
+			for (uint32_t j = g.begin((int)i); j < g.end((int)i); j++)
+			{
+				if (weighted)
+				{
+					out.put('(');
+					out.put(g.targets[j]); // вершина и вес
+					out.put(", ");
+					out.put(g.weights[j]);
+					out.put(") ");
+				}
+				else
+				{
+					out.put(g.targets[j]); // только вершина
+					out.put(' ');
+				}
+			}
+			out.put("\n\n");
+		}
+	});
+}
+
+// Строки матрицы собираются из дуг CSR: дуги вершины идут в порядке рёбер, поэтому при кратных
+// рёбрах в ячейке остаётся вес последнего, как в buildAdjacencyMatrix
+void savedAdjacencyMatrix(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path, int threads)
+{
+	csrGraph g = buildCsr(edgeList, vertices, directed, weighted, threads);
+	size_t rangeItems = writeRangeBytes / max<size_t>(1, (size_t)vertices * 2 + 1);
+
+	writeParallel(path, vertices, rangeItems, threads, "", [&](size_t first, size_t last, textBuffer& out)
+	{
+		vector<int> row(vertices, 0);
+		for (size_t i = first; i < last; i++)
+		{
+			for (uint32_t j = g.begin((int)i); j < g.end((int)i); j++)
+				row[g.targets[j]] = weighted ? g.weights[j] : 1;
+			for (int j = 0; j < vertices; j++)
+			{
+				out.put(row[j]);
+				out.put(' ');
+			}
+			out.put('\n');
+			for (uint32_t j = g.begin((int)i); j < g.end((int)i); j++)
+				row[g.targets[j]] = 0;
+		}
+	});
+}
+
+// Список рёбер: по строке "from to [weight]" на дугу, неориентированное ребро записывается
+// в обоих направлениях. Заголовок "# sorted" сообщает, что рёбра упорядочены по весу.
+void savedEdgeList(const vector<Edge>& edgeList, int directed, int weighted, bool sorted, string path, int threads)
+{
+	auto putArc = [weighted](textBuffer& out, int from, int to, int weight)
+	{
+		out.put(from);
+		out.put(' ');
+		out.put(to);
+		if (weighted)
+		{
+			out.put(' ');
+			out.put(weight);
+		}
+		out.put('\n');
+	};
+
+	writeParallel(path, edgeList.size(), writeRangeBytes / 16, threads, sorted ? "# sorted\n" : "", [&](size_t first, size_t last, textBuffer& out)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			const Edge& edge = edgeList[i];
+			putArc(out, edge.from, edge.to, edge.weight);
+			if (!directed && edge.from != edge.to)
+				putArc(out, edge.to, edge.from, edge.weight);
+		}
+	});
+}
+
+// Читает список рёбер; sorted становится true, если файл начинается с заголовка "# sorted"
+void readEdgeList(vector<Edge>& edgeList, int& vertices, bool& sorted, string path)
+{
+	ifstream inFile(path);
+	if (!inFile)
+	{
+		cerr << "Ошибка при открытии файла! \n";
+		exit(1);
+	}
+
+	string line;
+	vertices = 0;
+	sorted = false;
+
+	while (getline(inFile, line))
+	{
+		if (!line.empty() && line[0] == '#')
+		{
+			sorted = sorted || line.find("sorted") != string::npos;
+			continue;
+		}
+
+		istringstream iss(line);
+		Edge edge = { 0, 0, 0 };
+
+		if (!(iss >> edge.from >> edge.to))
+		{
+			cerr << "Ошибка в формате данных в строке: " << line << "\n";
+			continue;
 		}
+		iss >> edge.weight;
+
+		edgeList.push_back(edge);
+
+		vertices = max(vertices, max(edge.from, edge.to) + 1);
 	}
 
-	for (size_t i = 0; i < vertices; i++)
+	inFile.close();
+}
+
+// Разобранный участок файла списка смежности: строки "v: ..." по порядку и их дуги подряд
+struct adjacencyChunk
+{
+	const char* first;
+	const char* last;
+	vector<int> lineVertex;
+	vector<uint32_t> lineArcs; // число дуг в строке
+	vector<uint32_t> targets;
+	vector<int> weights;
+	int maxVertex = -1;
+	bool pairs = false, plain = false; // встречались "(v, w)" и просто "v"
+	const char* error = nullptr;       // начало строки с ошибкой формата
+};
+
+static bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* skipBlanks(const char* p, const char* end)
+{
+	while (p < end && isBlank(*p))
+		p++;
+	return p;
+}
+
+// Разбор строк [first; last) без выделения памяти на каждое число: числа читаются from_chars
+static void parseAdjacencyChunk(adjacencyChunk& chunk)
+{
+	const char* p = chunk.first;
+	const char* end = chunk.last;
+
+	while (p < end && !chunk.error)
 	{
-		for (size_t j = 0; j < vertices; j++)
+		const char* lineStart = p;
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (!lineEnd)
+			lineEnd = end;
+
+		p = skipBlanks(p, lineEnd);
+		if (p == lineEnd) // пустая строка
+		{
+			p = lineEnd + 1;
+			continue;
+		}
+
+		int vertex;
+		auto res = from_chars(p, lineEnd, vertex);
+		p = skipBlanks(res.ptr, lineEnd);
+		if (res.ec != errc() || vertex < 0 || p == lineEnd || *p != ':')
+		{
+			chunk.error = lineStart;
+			break;
+		}
+		p++;
+
+		uint32_t arcs = 0;
+		while ((p = skipBlanks(p, lineEnd)) < lineEnd)
 		{
-			outFile << adjMatrix[i][j] << " ";
+			int target, weight = 0;
+			bool pair = *p == '(';
+			if (pair)
+				p = skipBlanks(p + 1, lineEnd);
+
+			res = from_chars(p, lineEnd, target);
+			p = res.ptr;
+			if (res.ec != errc() || target < 0)
+			{
+				chunk.error = lineStart;
+				break;
+			}
+
+			if (pair)
+			{
+				p = skipBlanks(p, lineEnd);
+				if (p == lineEnd || *p != ',')
+				{
+					chunk.error = lineStart;
+					break;
+				}
+				res = from_chars(skipBlanks(p + 1, lineEnd), lineEnd, weight);
+				p = skipBlanks(res.ptr, lineEnd);
+				if (res.ec != errc() || p == lineEnd || *p != ')')
+				{
+					chunk.error = lineStart;
+					break;
+				}
+				p++;
+				chunk.weights.push_back(weight);
+			}
+
+			(pair ? chunk.pairs : chunk.plain) = true;
+			chunk.targets.push_back(target);
+			chunk.maxVertex = max(chunk.maxVertex, target);
+			arcs++;
 		}
-		outFile << "\n";
+
+		chunk.lineVertex.push_back(vertex);
+		chunk.lineArcs.push_back(arcs);
+		chunk.maxVertex = max(chunk.maxVertex, vertex);
+		p = lineEnd + 1;
 	}
+}
 
-	outFile.close();
+// Файл целиком блоками по 16 МБ
+static vector<char> readTextFile(const string& path)
+{
+	ifstream inFile(path, ios::binary);
+	if (!inFile)
+	{
+		cerr << "\nОшибка при открытии файла: " << path << "\n";
+		exit(1);
+	}
+
+	const size_t blockSize = 1 << 24;
+	vector<char> text;
+	inFile.seekg(0, ios::end);
+	text.reserve((size_t)max<streamoff>(0, inFile.tellg()));
+	inFile.seekg(0, ios::beg);
+	while (inFile)
+	{
+		size_t size = text.size();
+		text.resize(size + blockSize);
+		inFile.read(text.data() + size, blockSize);
+		text.resize(size + (size_t)inFile.gcount());
+	}
+	inFile.close();
+
+	return text;
+}
+
+// Делит текст на участки для threads потоков; границы участков сдвигаются к началу следующей
+// строки, чтобы строка не делилась между потоками. Chunk — структура с полями first и last
+template <typename Chunk>
+static vector<Chunk> splitLines(const vector<char>& text, int threads)
+{
+	const size_t minChunk = 1 << 20;
+	size_t parts = max<size_t>(1, min<size_t>((size_t)threads * 4, text.size() / minChunk));
+	const char* data = text.data();
+	const char* dataEnd = data + text.size();
+	vector<Chunk> chunks;
+	const char* chunkStart = data;
+	for (size_t i = 1; i <= parts && chunkStart < dataEnd; i++)
+	{
+		const char* chunkEnd = (i == parts) ? dataEnd : data + text.size() * i / parts;
+		if (chunkEnd < chunkStart)
+			chunkEnd = chunkStart;
+		const char* newline = (const char*)memchr(chunkEnd, '\n', dataEnd - chunkEnd);
+		chunkEnd = newline ? newline + 1 : dataEnd;
+
+		Chunk chunk;
+		chunk.first = chunkStart;
+		chunk.last = chunkEnd;
+		chunks.push_back(move(chunk));
+		chunkStart = chunkEnd;
+	}
+	return chunks;
+}
+
+static void reportThroughput(size_t bytes, chrono::steady_clock::time_point startTime)
+{
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	double megabytes = bytes / (1024.0 * 1024.0);
+	cout << "Прочитано " << megabytes << " МБ за " << seconds << " с (" << (seconds > 0 ? megabytes / seconds : 0) << " МБ/с)\n";
+}
+
+static void reportLineError(const char* line, const char* dataEnd)
+{
+	const char* lineEnd = (const char*)memchr(line, '\n', dataEnd - line);
+	cerr << "Ошибка: некорректный формат строки: " << string(line, lineEnd ? lineEnd : dataEnd) << "\n";
+	exit(1);
 }
 
-void generateGraph(int& vertices)
+// Читает список смежности в формате savedAdjacencyList: "v: (u, w) (u, w) ..." для взвешенного
+// графа и "v: u u ..." для невзвешенного. Файл читается большими блоками, делится на участки
+// по границам строк, и каждый участок разбирается в своём потоке; затем дуги раскладываются в CSR
+// в порядке файла. Число вершин — наибольший встреченный номер + 1. Выводит скорость чтения в МБ/с.
+csrGraph readAdjacencyList(string path, int threads)
 {
-	string inputfilePath = "input.txt", matrixFile = "matrix.txt", listFile = "list.txt";
-	vector<Edge> edgeList; //    
-	graphParameters graph;
+	auto startTime = chrono::steady_clock::now();
 
-	readData(inputfilePath, graph);
+	vector<char> text = readTextFile(path);
+	threads = threadCount(threads);
+	vector<adjacencyChunk> chunks = splitLines<adjacencyChunk>(text, threads);
+	const char* dataEnd = text.data() + text.size();
 
-	srand(time(0));
+	parallelFor(0, chunks.size(), threads, [&](size_t i) { parseAdjacencyChunk(chunks[i]); });
 
-	vertices = graph.Vmin + rand() % (graph.Vmax - graph.Vmin + 1);
-	int edges = graph.Emin + rand() % (graph.Emax - graph.Emin + 1);
+	int maxVertex = -1;
+	bool pairs = false, plain = false;
+	for (const auto& chunk : chunks)
+	{
+		if (chunk.error)
+			reportLineError(chunk.error, dataEnd);
+		maxVertex = max(maxVertex, chunk.maxVertex);
+		pairs = pairs || chunk.pairs;
+		plain = plain || chunk.plain;
+	}
 
-	cout << " : " << vertices << "\t : " << edges;
+	if (pairs && plain)
+	{
+		cerr << "Ошибка: в файле " << path << " смешаны взвешенные и невзвешенные списки.\n";
+		exit(1);
+	}
 
-	set<pair<int, int>> edgeSet;
+	// Позиции строк в CSR: вершина может встретиться в нескольких строках, её дуги идут в порядке файла
+	int vertices = maxVertex + 1;
+	auto buffers = make_shared<csrBuffers>();
+	csrBuffers& g = *buffers;
+	g.offsets.assign(vertices + 1, 0);
+	size_t arcs = 0;
+	for (const auto& chunk : chunks)
+	{
+		for (size_t line = 0; line < chunk.lineVertex.size(); line++)
+			g.offsets[chunk.lineVertex[line] + 1] += chunk.lineArcs[line];
+		arcs += chunk.targets.size();
+	}
 
-	for (size_t i = 0; i < edges; i++)
+	if (arcs > UINT32_MAX)
 	{
-		int from = rand() % vertices; //    ,     (from) 
-		int to = rand() % vertices; //    ,     (to) 
+		cerr << "Ошибка: слишком много дуг для 32-битного CSR.\n";
+		exit(1);
+	}
+
+	for (int v = 0; v < vertices; v++)
+		g.offsets[v + 1] += g.offsets[v];
 
-		if (!graph.self_loops && from == to) //   ,   
+	vector<vector<uint32_t>> linePos(chunks.size());
+	vector<uint32_t> cursor(g.offsets.begin(), g.offsets.end() - 1);
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		const auto& chunk = chunks[i];
+		linePos[i].resize(chunk.lineVertex.size());
+		for (size_t line = 0; line < chunk.lineVertex.size(); line++)
 		{
-			i--;
-			continue;
+			linePos[i][line] = cursor[chunk.lineVertex[line]];
+			cursor[chunk.lineVertex[line]] += chunk.lineArcs[line];
 		}
+	}
+
+	g.targets.resize(arcs);
+	if (pairs)
+		g.weights.resize(arcs);
 
-		if (!graph.directed && from > to) //   ,     
+	parallelFor(0, chunks.size(), threads, [&](size_t i)
+	{
+		const auto& chunk = chunks[i];
+		size_t arc = 0;
+		for (size_t line = 0; line < chunk.lineVertex.size(); line++)
 		{
-			swap(from, to);
+			uint32_t n = chunk.lineArcs[line];
+			copy(chunk.targets.begin() + arc, chunk.targets.begin() + arc + n, g.targets.begin() + linePos[i][line]);
+			if (pairs)
+				copy(chunk.weights.begin() + arc, chunk.weights.begin() + arc + n, g.weights.begin() + linePos[i][line]);
+			arc += n;
 		}
+	});
+
+	reportThroughput(text.size(), startTime);
 
-		if (edgeSet.count({ from, to })) //    
+	return makeCsr(vertices, pairs, buffers);
+}
+
+// Разобранный участок файла матрицы смежности: ненулевые ячейки строк подряд
+struct matrixChunk
+{
+	const char* first;
+	const char* last;
+	vector<uint32_t> rowArcs; // число ненулевых ячеек в строке
+	vector<uint32_t> targets;
+	vector<int> weights;
+	long long minColumns = LLONG_MAX, maxColumns = 0;
+	bool weighted = false; // встречались значения кроме 0 и 1
+	const char* error = nullptr;
+};
+
+static void parseMatrixChunk(matrixChunk& chunk)
+{
+	const char* p = chunk.first;
+	const char* end = chunk.last;
+
+	while (p < end && !chunk.error)
+	{
+		const char* lineStart = p;
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (!lineEnd)
+			lineEnd = end;
+
+		p = skipBlanks(p, lineEnd);
+		if (p == lineEnd)
 		{
-			i--;
+			p = lineEnd + 1;
 			continue;
 		}
 
-		edgeSet.insert({ from, to });
+		uint32_t arcs = 0;
+		long long column = 0;
+		while ((p = skipBlanks(p, lineEnd)) < lineEnd)
+		{
+			// Нули — почти все ячейки разреженной матрицы, они пропускаются без разбора числа
+			if (*p == '0' && (p + 1 == lineEnd || isBlank(p[1])))
+			{
+				p++;
+				column++;
+				continue;
+			}
+
+			int value;
+			auto res = from_chars(p, lineEnd, value);
+			if (res.ec != errc() || column > UINT32_MAX)
+			{
+				chunk.error = lineStart;
+				break;
+			}
+			p = res.ptr;
+			if (value != 0)
+			{
+				chunk.targets.push_back((uint32_t)column);
+				chunk.weights.push_back(value);
+				chunk.weighted = chunk.weighted || value != 1;
+				arcs++;
+			}
+			column++;
+		}
+
+		chunk.rowArcs.push_back(arcs);
+		chunk.minColumns = min(chunk.minColumns, column);
+		chunk.maxColumns = max(chunk.maxColumns, column);
+		p = lineEnd + 1;
+	}
+}
+
+// Читает матрицу смежности в формате savedAdjacencyMatrix сразу в CSR, не храня V x V чисел:
+// участки файла разбираются параллельно, сохраняются только ненулевые ячейки. Значение ячейки —
+// вес дуги; граф считается взвешенным, если встретилось значение, отличное от 0 и 1
+csrGraph readAdjacencyMatrix(string path, int threads)
+{
+	auto startTime = chrono::steady_clock::now();
+
+	vector<char> text = readTextFile(path);
+	threads = threadCount(threads);
+	vector<matrixChunk> chunks = splitLines<matrixChunk>(text, threads);
+	const char* dataEnd = text.data() + text.size();
+
+	parallelFor(0, chunks.size(), threads, [&](size_t i) { parseMatrixChunk(chunks[i]); });
+
+	size_t rows = 0, arcs = 0;
+	bool weighted = false;
+	for (const auto& chunk : chunks)
+	{
+		if (chunk.error)
+			reportLineError(chunk.error, dataEnd);
+		rows += chunk.rowArcs.size();
+		arcs += chunk.targets.size();
+		weighted = weighted || chunk.weighted;
+	}
+
+	for (const auto& chunk : chunks)
+	{
+		if (!chunk.rowArcs.empty() && (chunk.minColumns != (long long)rows || chunk.maxColumns != (long long)rows))
+		{
+			cerr << "Ошибка: матрица в файле " << path << " не квадратная.\n";
+			exit(1);
+		}
+	}
+
+	if (rows > INT32_MAX || arcs > UINT32_MAX)
+	{
+		cerr << "Ошибка: слишком много дуг для 32-битного CSR.\n";
+		exit(1);
+	}
+
+	// Строки идут по порядку, поэтому дуги участка занимают в CSR один непрерывный отрезок
+	auto buffers = make_shared<csrBuffers>();
+	csrBuffers& g = *buffers;
+	g.offsets.assign(rows + 1, 0);
+	g.targets.resize(arcs);
+	if (weighted)
+		g.weights.resize(arcs);
 
-		int weight = 0;
-		if (graph.weighted)
+	vector<size_t> chunkRow(chunks.size()), chunkArc(chunks.size());
+	size_t row = 0, arc = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		chunkRow[i] = row;
+		chunkArc[i] = arc;
+		for (uint32_t rowArcs : chunks[i].rowArcs)
 		{
-			weight = graph.Wmin + rand() % (graph.Wmax - graph.Wmin + 1);
+			g.offsets[row + 1] = g.offsets[row] + rowArcs;
+			row++;
 		}
+		arc += chunks[i].targets.size();
+	}
+
+	parallelFor(0, chunks.size(), threads, [&](size_t i)
+	{
+		copy(chunks[i].targets.begin(), chunks[i].targets.end(), g.targets.begin() + chunkArc[i]);
+		if (weighted)
+			copy(chunks[i].weights.begin(), chunks[i].weights.end(), g.weights.begin() + chunkArc[i]);
+	});
+
+	reportThroughput(text.size(), startTime);
+
+	return makeCsr((int)rows, weighted, buffers);
+}
+
+// Файл Matrix Market в координатном формате: ненулевые ячейки "i j [w]" с нумерацией с 1.
+// Для неориентированного графа матрица симметрична и записывается только её нижний треугольник.
+// При кратных рёбрах, как и в матрице смежности, остаётся вес последнего
+void savedMatrixMarket(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path, int threads)
+{
+	csrGraph g = buildCsr(edgeList, vertices, directed, weighted, threads);
 
-		edgeList.push_back({ from, to, weight });
+	// Ячейка (v, t) записывается на месте последней дуги v -> t
+	vector<uint8_t> keep(g.arcs(), 0);
+	vector<int> last(vertices, -1);
+	size_t entries = 0;
+	for (int v = 0; v < vertices; v++)
+	{
+		for (uint32_t i = g.begin(v); i < g.end(v); i++)
+			last[g.targets[i]] = (int)i;
+		for (uint32_t i = g.begin(v); i < g.end(v); i++)
+		{
+			uint32_t t = g.targets[i];
+			if (last[t] == (int)i && (directed || t <= (uint32_t)v))
+			{
+				keep[i] = 1;
+				entries++;
+			}
+		}
 	}
 
-	savedAdjacencyMatrix(edgeList, vertices, graph.directed, graph.weighted, matrixFile);
+	string header = "%%MatrixMarket matrix coordinate ";
+	header += weighted ? "integer " : "pattern ";
+	header += directed ? "general\n" : "symmetric\n";
+	header += to_string(vertices) + " " + to_string(vertices) + " " + to_string(entries) + "\n";
 
-	savedAdjacencyList(edgeList, vertices, graph.directed, graph.weighted, listFile);
-}
\ No newline at end of file
+	size_t rangeItems = writeRangeBytes / max<size_t>(1, g.arcs() * 10 / max(1, vertices) + 8);
+	writeParallel(path, vertices, rangeItems, threads, header, [&](size_t first, size_t last, textBuffer& out)
+	{
+		for (size_t v = first; v < last; v++)
+		{
+			for (uint32_t i = g.begin((int)v); i < g.end((int)v); i++)
+			{
+				if (!keep[i])
+					continue;
+				out.put((long long)v + 1);
+				out.put(' ');
+				out.put((long long)g.targets[i] + 1);
+				if (weighted)
+				{
+					out.put(' ');
+					out.put(g.weights[i]);
+				}
+				out.put('\n');
+			}
+		}
+	});
+}
+
+// Двоичный файл графа, версия 1. Заголовок binaryGraphHeader, за ним массивы CSR
+// offsets (vertices + 1 чисел uint32), targets (arcs чисел uint32) и, для взвешенного графа,
+// weights (arcs чисел int32). В файле со сжатыми списками (бит 2 флагов) на тех же местах
+// лежат blockStart (uint64), vertexStart (uint32) и байты списков до конца файла. Каждый
+// массив начинается с адреса, кратного 64 байтам, поэтому после отображения файла в память
+// алгоритмы работают прямо с его страницами без разбора и копирования.
+const char binaryGraphMagic[8] = { 'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H' };
+const uint32_t binaryGraphVersion = 1;
+const uint32_t binaryGraphByteOrder = 0x01020304; // прочитается иначе на машине с другим порядком байтов
+const uint64_t binaryGraphAlign = 64;
+
+struct binaryGraphHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t flags; // бит 0 — взвешенный, бит 1 — ориентированный, бит 2 — сжатые списки
+	uint32_t reserved;
+	uint64_t vertices;
+	uint64_t arcs;
+	uint64_t offsetsPos; // смещения массивов от начала файла
+	uint64_t targetsPos;
+	uint64_t weightsPos; // 0 для невзвешенного графа
+	uint64_t fileSize;
+};
+
+static uint64_t alignUp(uint64_t pos)
+{
+	return (pos + binaryGraphAlign - 1) / binaryGraphAlign * binaryGraphAlign;
+}
+
+static binaryGraphHeader makeBinaryHeader(int vertices, size_t arcs, int weighted, int directed, bool compressed)
+{
+	binaryGraphHeader header = {};
+	memcpy(header.magic, binaryGraphMagic, sizeof(header.magic));
+	header.version = binaryGraphVersion;
+	header.byteOrder = binaryGraphByteOrder;
+	header.flags = (weighted ? 1u : 0u) | (directed ? 2u : 0u) | (compressed ? 4u : 0u);
+	header.vertices = vertices;
+	header.arcs = arcs;
+	return header;
+}
+
+// Пишет заголовок и массивы; каждый массив начинается с позиции, выровненной на 64 байта
+static void writeBinaryFile(const string& path, binaryGraphHeader& header, const vector<pair<const void*, uint64_t>>& arrays)
+{
+	ofstream outFile(path, ios::binary);
+	if (!outFile)
+	{
+		cerr << "Ошибка при открытии файла! \n";
+		exit(1);
+	}
+
+	uint64_t* positions[3] = { &header.offsetsPos, &header.targetsPos, &header.weightsPos };
+	uint64_t end = sizeof(header);
+	for (size_t i = 0; i < arrays.size(); i++)
+	{
+		*positions[i] = alignUp(end);
+		end = *positions[i] + arrays[i].second;
+	}
+	header.fileSize = end;
+
+	uint64_t written = 0;
+	auto put = [&](uint64_t pos, const void* data, uint64_t bytes)
+	{
+		static const char zeros[binaryGraphAlign] = {};
+		outFile.write(zeros, pos - written); // выравнивание до начала массива
+		outFile.write((const char*)data, bytes);
+		written = pos + bytes;
+	};
+
+	put(0, &header, sizeof(header));
+	for (size_t i = 0; i < arrays.size(); i++)
+		put(*positions[i], arrays[i].first, arrays[i].second);
+
+	if (!outFile)
+	{
+		cerr << "Ошибка при записи файла " << path << "\n";
+		exit(1);
+	}
+	outFile.close();
+}
+
+void savedBinaryGraph(const csrGraph& g, int directed, string path)
+{
+	binaryGraphHeader header = makeBinaryHeader(g.vertices, g.arcs(), g.weighted, directed, false);
+	vector<pair<const void*, uint64_t>> arrays = {
+		{ g.offsets, ((uint64_t)g.vertices + 1) * sizeof(uint32_t) },
+		{ g.targets, g.arcs() * sizeof(uint32_t) } };
+	if (g.weighted)
+		arrays.push_back({ g.weights, g.arcs() * sizeof(int) });
+	writeBinaryFile(path, header, arrays);
+}
+
+void savedCompressedGraph(const compressedGraph& g, int directed, string path)
+{
+	binaryGraphHeader header = makeBinaryHeader(g.vertices, g.arcs(), g.weighted, directed, true);
+	writeBinaryFile(path, header, {
+		{ g.blockStart, ((uint64_t)g.vertices + 63) / 64 * sizeof(uint64_t) },
+		{ g.vertexStart, (uint64_t)g.vertices * sizeof(uint32_t) },
+		{ g.bytes, g.byteCount } });
+}
+
+void savedBinaryGraph(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path)
+{
+	savedBinaryGraph(buildCsr(edgeList, vertices, directed, weighted), directed, path);
+}
+
+// Файл, отображённый в память только для чтения; отображение снимается вместе с последней копией графа
+struct mappedFile
+{
+	const char* data = nullptr;
+	uint64_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+
+	~mappedFile()
+	{
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	}
+#else
+	~mappedFile()
+	{
+		if (data) munmap((void*)data, size);
+	}
+#endif
+};
+
+static shared_ptr<mappedFile> mapFile(const string& path)
+{
+	auto mapped = make_shared<mappedFile>();
+#ifdef _WIN32
+	mapped->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	LARGE_INTEGER size;
+	if (mapped->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(mapped->file, &size))
+		return nullptr;
+	mapped->size = (uint64_t)size.QuadPart;
+	if (mapped->size < sizeof(binaryGraphHeader))
+		return mapped;
+	mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapped->mapping)
+		return nullptr;
+	mapped->data = (const char*)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0)
+	{
+		if (fd >= 0) close(fd);
+		return nullptr;
+	}
+	mapped->size = (uint64_t)st.st_size;
+	if (mapped->size < sizeof(binaryGraphHeader))
+	{
+		close(fd);
+		return mapped;
+	}
+	void* data = mmap(nullptr, mapped->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // отображение остаётся действительным и после закрытия дескриптора
+	if (data == MAP_FAILED)
+		return nullptr;
+	mapped->data = (const char*)data;
+#endif
+	return mapped->data ? mapped : nullptr;
+}
+
+// Отображает файл и проверяет заголовок: сигнатуру, версию, порядок байтов и вид списков
+static binaryGraphHeader openBinaryFile(const string& path, bool compressed, shared_ptr<mappedFile>& mapped)
+{
+	mapped = mapFile(path);
+	if (!mapped)
+	{
+		cerr << "Ошибка при открытии файла! \n";
+		exit(1);
+	}
+
+	binaryGraphHeader header;
+	if (mapped->size < sizeof(header))
+	{
+		cerr << "Ошибка: файл " << path << " не является двоичным файлом графа.\n";
+		exit(1);
+	}
+	memcpy(&header, mapped->data, sizeof(header));
+
+	if (memcmp(header.magic, binaryGraphMagic, sizeof(header.magic)) != 0)
+	{
+		cerr << "Ошибка: файл " << path << " не является двоичным файлом графа.\n";
+		exit(1);
+	}
+	if (header.version != binaryGraphVersion || header.byteOrder != binaryGraphByteOrder)
+	{
+		cerr << "Ошибка: неподдерживаемая версия или порядок байтов файла " << path << ".\n";
+		exit(1);
+	}
+	if (((header.flags & 4) != 0) != compressed)
+	{
+		cerr << "Ошибка: файл " << path << (compressed ? " не содержит" : " содержит") << " сжатые списки смежности.\n";
+		exit(1);
+	}
+	if (header.vertices > INT32_MAX || header.fileSize != mapped->size || header.weightsPos > mapped->size ||
+		header.offsetsPos % binaryGraphAlign || header.targetsPos % binaryGraphAlign || header.weightsPos % binaryGraphAlign)
+	{
+		cerr << "Ошибка: повреждён заголовок файла " << path << ".\n";
+		exit(1);
+	}
+
+	return header;
+}
+
+// Открывает двоичный файл графа. Массивы не читаются: граф указывает прямо в отображённый файл,
+// страницы подгружаются системой при первом обращении
+csrGraph openBinaryGraph(string path, int& directed)
+{
+	shared_ptr<mappedFile> mapped;
+	binaryGraphHeader header = openBinaryFile(path, false, mapped);
+
+	bool weighted = header.flags & 1;
+	if (header.arcs > UINT32_MAX ||
+		header.offsetsPos + (header.vertices + 1) * sizeof(uint32_t) > mapped->size ||
+		header.targetsPos + header.arcs * sizeof(uint32_t) > mapped->size ||
+		(weighted && header.weightsPos + header.arcs * sizeof(int) > mapped->size))
+	{
+		cerr << "Ошибка: повреждён заголовок файла " << path << ".\n";
+		exit(1);
+	}
+
+	csrGraph g;
+	g.vertices = (int)header.vertices;
+	g.weighted = weighted;
+	g.arcCount = header.arcs;
+	g.offsets = (const uint32_t*)(mapped->data + header.offsetsPos);
+	g.targets = (const uint32_t*)(mapped->data + header.targetsPos);
+	g.weights = weighted ? (const int*)(mapped->data + header.weightsPos) : nullptr;
+	g.storage = mapped;
+
+	if (g.offsets[0] != 0 || g.offsets[g.vertices] != header.arcs)
+	{
+		cerr << "Ошибка: повреждены данные файла " << path << ".\n";
+		exit(1);
+	}
+
+	directed = (header.flags & 2) ? 1 : 0;
+	return g;
+}
+
+compressedGraph openCompressedGraph(string path, int& directed)
+{
+	shared_ptr<mappedFile> mapped;
+	binaryGraphHeader header = openBinaryFile(path, true, mapped);
+
+	uint64_t blocks = (header.vertices + 63) / 64;
+	if (header.offsetsPos + blocks * sizeof(uint64_t) > mapped->size ||
+		header.targetsPos + header.vertices * sizeof(uint32_t) > mapped->size)
+	{
+		cerr << "Ошибка: повреждён заголовок файла " << path << ".\n";
+		exit(1);
+	}
+
+	compressedGraph g;
+	g.vertices = (int)header.vertices;
+	g.weighted = header.flags & 1;
+	g.arcCount = header.arcs;
+	g.byteCount = mapped->size - header.weightsPos;
+	g.blockStart = (const uint64_t*)(mapped->data + header.offsetsPos);
+	g.vertexStart = (const uint32_t*)(mapped->data + header.targetsPos);
+	g.bytes = (const uint8_t*)(mapped->data + header.weightsPos);
+	g.storage = mapped;
+
+	if (g.vertices > 0 && g.blockStart[blocks - 1] >= g.byteCount)
+	{
+		cerr << "Ошибка: повреждены данные файла " << path << ".\n";
+		exit(1);
+	}
+
+	directed = (header.flags & 2) ? 1 : 0;
+	return g;
+}
+
+// Упорядочивает рёбра по весу раскладкой по корзинам — по одной на каждое значение веса
+// из [Wmin; Wmax]. Рёбра переставляются на месте за O(E + Wmax - Wmin) без сравнений.
+void bucketSortByWeight(vector<Edge>& edgeList, int Wmin, int Wmax)
+{
+	size_t buckets = (size_t)((long long)Wmax - Wmin + 1);
+	vector<size_t> head(buckets + 1, 0), tail;
+
+	for (const auto& edge : edgeList)
+		head[edge.weight - Wmin + 1]++;
+	for (size_t b = 0; b < buckets; b++)
+		head[b + 1] += head[b];
+	tail.assign(head.begin() + 1, head.end());
+
+	for (size_t b = 0; b < buckets; b++)
+	{
+		while (head[b] < tail[b])
+		{
+			size_t target = edgeList[head[b]].weight - Wmin;
+			if (target == b)
+				head[b]++;
+			else
+				swap(edgeList[head[b]], edgeList[head[target]++]);
+		}
+	}
+}
+
+int lowestBit(uint64_t x)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (int)index;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+int highestBit(uint64_t x)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, x);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(x);
+#endif
+}
+
+int bitCount(uint64_t x)
+{
+#ifdef _MSC_VER
+	return (int)__popcnt64(x);
+#else
+	return __builtin_popcountll(x);
+#endif
+}
+
+static void writeVarint(vector<uint8_t>& out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+struct compressedBuffers
+{
+	vector<uint64_t> blockStart;
+	vector<uint32_t> vertexStart;
+	vector<uint8_t> bytes;
+};
+
+// Сжатие CSR: диапазоны вершин кодируются параллельно в отдельные буферы, затем склеиваются
+compressedGraph compressGraph(const csrGraph& g, int threads)
+{
+	threads = threadCount(threads);
+	int vertices = g.vertices;
+	size_t ranges = min<size_t>((size_t)threads * 4, ((size_t)vertices + 4095) / 4096);
+	ranges = max<size_t>(ranges, 1);
+
+	vector<vector<uint8_t>> rangeBytes(ranges);
+	vector<uint64_t> start((size_t)vertices + 1, 0); // начало списка вершины внутри буфера диапазона
+	auto rangeFirst = [&](size_t r) { return (int)((long long)vertices * r / ranges); };
+
+	parallelFor(0, ranges, threads, [&](size_t r)
+	{
+		vector<arc> sorted;
+		vector<uint8_t>& out = rangeBytes[r];
+		for (int v = rangeFirst(r); v < rangeFirst(r + 1); v++)
+		{
+			start[v] = out.size();
+			sorted.clear();
+			for (arc a : g.neighbors(v))
+				sorted.push_back(a);
+			sort(sorted.begin(), sorted.end(), [](const arc& a, const arc& b) { return a.target < b.target; });
+
+			writeVarint(out, sorted.size());
+			long long previous = v;
+			for (size_t i = 0; i < sorted.size(); i++)
+			{
+				long long delta = (long long)sorted[i].target - previous;
+				writeVarint(out, i == 0 ? zigzag(delta) : (uint64_t)delta);
+				if (g.weighted)
+					writeVarint(out, zigzag(sorted[i].weight));
+				previous = sorted[i].target;
+			}
+		}
+	});
+
+	vector<uint64_t> rangeBase(ranges + 1, 0);
+	for (size_t r = 0; r < ranges; r++)
+		rangeBase[r + 1] = rangeBase[r] + rangeBytes[r].size();
+
+	auto buffers = make_shared<compressedBuffers>();
+	buffers->blockStart.resize(((size_t)vertices + 63) / 64);
+	buffers->vertexStart.resize(vertices);
+	buffers->bytes.resize(rangeBase[ranges]);
+
+	for (size_t r = 0; r < ranges; r++)
+		for (int v = rangeFirst(r); v < rangeFirst(r + 1); v++)
+			start[v] += rangeBase[r];
+	for (int v = 0; v < vertices; v++)
+	{
+		if (v % 64 == 0)
+			buffers->blockStart[v / 64] = start[v];
+		uint64_t relative = start[v] - buffers->blockStart[v / 64];
+		if (relative > UINT32_MAX)
+		{
+			cerr << "Ошибка: слишком длинные списки смежности для сжатого представления.\n";
+			exit(1);
+		}
+		buffers->vertexStart[v] = (uint32_t)relative;
+	}
+
+	parallelFor(0, ranges, threads, [&](size_t r)
+	{
+		copy(rangeBytes[r].begin(), rangeBytes[r].end(), buffers->bytes.begin() + rangeBase[r]);
+		vector<uint8_t>().swap(rangeBytes[r]);
+	});
+
+	compressedGraph c;
+	c.vertices = vertices;
+	c.weighted = g.weighted;
+	c.arcCount = g.arcs();
+	c.byteCount = buffers->bytes.size();
+	c.blockStart = buffers->blockStart.data();
+	c.vertexStart = buffers->vertexStart.data();
+	c.bytes = buffers->bytes.data();
+	c.storage = buffers;
+	return c;
+}
+
+// Транспонирование через промежуточный CSR обратного графа
+compressedGraph compressedGraph::transposed(int threads) const
+{
+	auto buffers = make_shared<csrBuffers>();
+	csrBuffers& t = *buffers;
+	t.offsets.assign((size_t)vertices + 1, 0);
+	t.targets.resize(arcCount);
+	if (weighted)
+		t.weights.resize(arcCount);
+
+	for (int v = 0; v < vertices; v++)
+		for (arc a : neighbors(v))
+			t.offsets[a.target + 1]++;
+	for (int v = 0; v < vertices; v++)
+		t.offsets[v + 1] += t.offsets[v];
+
+	vector<uint32_t> cursor(t.offsets.begin(), t.offsets.end() - 1);
+	for (int v = 0; v < vertices; v++)
+	{
+		for (arc a : neighbors(v))
+		{
+			uint32_t pos = cursor[a.target]++;
+			t.targets[pos] = v;
+			if (weighted) t.weights[pos] = a.weight;
+		}
+	}
+
+	return compressGraph(makeCsr(vertices, weighted, buffers), threads);
+}
+
+bitMatrix::bitMatrix(int vertices) : vertices(vertices), rowWords(((size_t)vertices + 63) / 64), bits((size_t)vertices * rowWords, 0)
+{
+}
+
+int bitMatrix::degree(int v) const
+{
+	const uint64_t* r = row(v);
+	int count = 0;
+	for (size_t w = 0; w < rowWords; w++)
+		count += bitCount(r[w]);
+	return count;
+}
+
+int bitMatrix::commonNeighbors(int u, int v) const
+{
+	const uint64_t* a = row(u);
+	const uint64_t* b = row(v);
+	int count = 0;
+	for (size_t w = 0; w < rowWords; w++)
+		count += bitCount(a[w] & b[w]);
+	return count;
+}
+
+// Транспонирование блока 64 x 64 на месте: бит j слова i меняется местами с битом i слова j.
+// Обмениваются половины, затем четверти и т.д. — 6 шагов по 32 операции над словами
+static void transposeBlock(uint64_t a[64])
+{
+	uint64_t mask = 0x00000000FFFFFFFFull;
+	for (int j = 32; j != 0; j >>= 1, mask ^= (mask << j))
+	{
+		for (int k = 0; k < 64; k = ((k | j) + 1) & ~j)
+		{
+			uint64_t t = ((a[k] >> j) ^ a[k | j]) & mask;
+			a[k | j] ^= t;
+			a[k] ^= (t << j);
+		}
+	}
+}
+
+// Транспонированная матрица (обратный граф) блоками 64 x 64, блочные строки — в разных потоках
+bitMatrix bitMatrix::transposed(int threads) const
+{
+	bitMatrix t(vertices);
+	parallelFor(0, rowWords, threadCount(threads), [&](size_t blockRow)
+	{
+		uint64_t block[64];
+		for (size_t blockCol = 0; blockCol < rowWords; blockCol++)
+		{
+			for (size_t r = 0; r < 64; r++)
+			{
+				size_t v = blockRow * 64 + r;
+				block[r] = v < (size_t)vertices ? bits[v * rowWords + blockCol] : 0;
+			}
+			transposeBlock(block);
+			for (size_t r = 0; r < 64; r++)
+			{
+				size_t v = blockCol * 64 + r;
+				if (v < (size_t)vertices)
+					t.bits[v * rowWords + blockRow] = block[r];
+			}
+		}
+	});
+	return t;
+}
+
+bitMatrix buildBitMatrix(const vector<Edge>& edgeList, int vertices, int directed)
+{
+	bitMatrix m(vertices);
+	for (const auto& edge : edgeList)
+	{
+		m.set(edge.from, edge.to);
+		if (!directed)
+			m.set(edge.to, edge.from);
+	}
+	return m;
+}
+
+bitMatrix buildBitMatrix(const csrGraph& g)
+{
+	bitMatrix m(g.vertices);
+	for (int v = 0; v < g.vertices; v++)
+		for (uint32_t i = g.begin(v); i < g.end(v); i++)
+			m.set(v, g.targets[i]);
+	return m;
+}
+
+// Запись в формате savedAdjacencyMatrix для невзвешенного графа: "0 1 0 ... \n"
+void savedBitMatrix(const bitMatrix& m, string path, int threads)
+{
+	size_t rangeItems = writeRangeBytes / max<size_t>(1, (size_t)m.vertices * 2 + 1);
+	writeParallel(path, m.vertices, rangeItems, threads, "", [&](size_t first, size_t last, textBuffer& out)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			for (int j = 0; j < m.vertices; j++)
+				out.put(m.get((int)i, j) ? "1 " : "0 ");
+			out.put('\n');
+		}
+	});
+}
+
+// Читает матрицу смежности из текстового файла: ненулевая ячейка — дуга. Число вершин — число
+// непустых строк; в каждой строке должно быть столько же чисел
+bitMatrix readBitMatrix(string path)
+{
+	ifstream inFile(path);
+	if (!inFile)
+	{
+		cerr << "\nОшибка при открытии файла: " << path << "\n";
+		exit(1);
+	}
+
+	vector<string> lines;
+	string line;
+	while (getline(inFile, line))
+		if (line.find_first_not_of(" \t\r") != string::npos)
+			lines.push_back(move(line));
+	inFile.close();
+
+	bitMatrix m((int)lines.size());
+	for (int i = 0; i < m.vertices; i++)
+	{
+		const char* p = lines[i].data();
+		const char* end = p + lines[i].size();
+		int j = 0;
+		while ((p = skipBlanks(p, end)) < end)
+		{
+			int cell;
+			auto res = from_chars(p, end, cell);
+			if (res.ec != errc() || j >= m.vertices)
+			{
+				cerr << "Ошибка: некорректная строка матрицы смежности: " << i << "\n";
+				exit(1);
+			}
+			if (cell)
+				m.set(i, j);
+			p = res.ptr;
+			j++;
+		}
+		if (j != m.vertices)
+		{
+			cerr << "Ошибка: некорректная строка матрицы смежности: " << i << "\n";
+			exit(1);
+		}
+	}
+
+	return m;
+}
+
+// Новые номера вершин в порядке order; newId — позиция вершины в этом порядке
+static vertexPermutation fromSequence(vector<int> sequence)
+{
+	vertexPermutation p;
+	p.newId.resize(sequence.size());
+	for (size_t i = 0; i < sequence.size(); i++)
+		p.newId[sequence[i]] = (int)i;
+	p.oldId = move(sequence);
+	return p;
+}
+
+// Обход в ширину из start; при byDegree соседи берутся по возрастанию степени (Катхилл–Макки)
+static void breadthFirstOrder(const csrGraph& g, int start, bool byDegree, vector<bool>& visited, vector<int>& sequence)
+{
+	size_t head = sequence.size();
+	sequence.push_back(start);
+	visited[start] = true;
+	vector<int> next;
+	while (head < sequence.size())
+	{
+		int v = sequence[head++];
+		next.clear();
+		for (arc a : g.neighbors(v))
+		{
+			if (!visited[a.target])
+			{
+				visited[a.target] = true;
+				next.push_back(a.target);
+			}
+		}
+		if (byDegree)
+			stable_sort(next.begin(), next.end(), [&](int a, int b) { return g.degree(a) < g.degree(b); });
+		sequence.insert(sequence.end(), next.begin(), next.end());
+	}
+}
+
+vertexPermutation computeOrder(const csrGraph& g, int order)
+{
+	if (order == originalOrder)
+		return vertexPermutation();
+
+	vector<int> sequence(g.vertices);
+	for (int v = 0; v < g.vertices; v++)
+		sequence[v] = v;
+
+	if (order == degreeOrder)
+	{
+		stable_sort(sequence.begin(), sequence.end(), [&](int a, int b) { return g.degree(a) > g.degree(b); });
+		return fromSequence(move(sequence));
+	}
+
+	// RCM начинает каждую компоненту с вершины наименьшей степени, BFS — с вершины с меньшим номером
+	vector<int> starts = sequence;
+	if (order == rcmOrder)
+		stable_sort(starts.begin(), starts.end(), [&](int a, int b) { return g.degree(a) < g.degree(b); });
+
+	vector<bool> visited(g.vertices, false);
+	sequence.clear();
+	for (int start : starts)
+		if (!visited[start])
+			breadthFirstOrder(g, start, order == rcmOrder, visited, sequence);
+
+	if (order == rcmOrder)
+		reverse(sequence.begin(), sequence.end());
+	return fromSequence(move(sequence));
+}
+
+// Граф с новыми номерами вершин; дуги каждой вершины сохраняют прежний порядок
+csrGraph permuteGraph(const csrGraph& g, const vertexPermutation& p, int threads)
+{
+	if (p.newId.empty())
+		return g;
+
+	auto buffers = make_shared<csrBuffers>();
+	csrBuffers& t = *buffers;
+	t.offsets.assign((size_t)g.vertices + 1, 0);
+	for (int u = 0; u < g.vertices; u++)
+		t.offsets[u + 1] = t.offsets[u] + g.degree(p.oldId[u]);
+	t.targets.resize(g.arcs());
+	if (g.weighted)
+		t.weights.resize(g.arcs());
+
+	parallelFor(0, g.vertices, threadCount(threads), [&](size_t u)
+	{
+		int v = p.oldId[u];
+		uint32_t pos = t.offsets[u];
+		for (uint32_t i = g.begin(v); i < g.end(v); i++, pos++)
+		{
+			t.targets[pos] = p.newId[g.targets[i]];
+			if (g.weighted) t.weights[pos] = g.weights[i];
+		}
+	});
+
+	return makeCsr(g.vertices, g.weighted, buffers);
+}
+
+void permuteEdges(vector<Edge>& edgeList, const vertexPermutation& p)
+{
+	if (p.newId.empty())
+		return;
+	for (auto& edge : edgeList)
+	{
+		edge.from = p.newId[edge.from];
+		edge.to = p.newId[edge.to];
+	}
+}
+
+void benchmarkOrders(const csrGraph& g, int threads, const function<void(const csrGraph&, const vertexPermutation&)>& run)
+{
+	const char* names[] = { "исходный", "по степени", "RCM", "BFS" };
+	cout << "\nПорядок вершин\tперестановка, с\tалгоритм, с\tдальние дуги, %\n";
+
+	// Вывод алгоритма на время замеров отключается
+	streambuf* console = cout.rdbuf();
+	for (int order = originalOrder; order <= bfsOrder; order++)
+	{
+		auto startTime = chrono::steady_clock::now();
+		vertexPermutation p = computeOrder(g, order);
+		csrGraph permuted = permuteGraph(g, p, threads);
+		auto permutedTime = chrono::steady_clock::now();
+
+		cout.rdbuf(nullptr);
+		run(permuted, p);
+		cout.clear();
+		cout.rdbuf(console);
+		auto endTime = chrono::steady_clock::now();
+
+		size_t far = 0;
+		for (int v = 0; v < permuted.vertices; v++)
+			for (arc a : permuted.neighbors(v))
+				far += abs((long long)a.target - v) >= 16;
+
+		cout << names[order] << "\t" << chrono::duration<double>(permutedTime - startTime).count()
+			<< "\t" << chrono::duration<double>(endTime - permutedTime).count()
+			<< "\t" << (permuted.arcs() ? 100.0 * far / permuted.arcs() : 0) << "\n";
+	}
+}
+
+// Количество всех возможных рёбер с учётом ориентированности и петель
+long long maxEdges(int vertices, int directed, int self_loops)
+{
+	long long v = vertices;
+	if (directed)
+		return self_loops ? v * v : v * (v - 1);
+	return self_loops ? v * (v + 1) / 2 : v * (v - 1) / 2;
+}
+
+void philoxRng::nextBlock()
+{
+	uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter >> 32);
+	uint32_t c2 = (uint32_t)stream, c3 = (uint32_t)(stream >> 32);
+	uint32_t k0 = key0, k1 = key1;
+
+	for (int round = 0; round < 10; round++)
+	{
+		uint64_t p0 = (uint64_t)0xD2511F53u * c0, p1 = (uint64_t)0xCD9E8D57u * c2;
+		uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c0 = n0;
+		c1 = (uint32_t)p1;
+		c2 = n2;
+		c3 = (uint32_t)p0;
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+
+	block[0] = c0;
+	block[1] = c1;
+	block[2] = c2;
+	block[3] = c3;
+	counter++;
+}
+
+// Случайное целое из [lo; hi] без смещения (не зависит от реализации стандартной библиотеки)
+long long uniformInt(philoxRng& rng, long long lo, long long hi)
+{
+	uint64_t range = (uint64_t)(hi - lo) + 1;
+	if (range == 0)
+		return (long long)rng();
+	uint64_t limit = UINT64_MAX - UINT64_MAX % range, x;
+	do
+	{
+		x = rng();
+	} while (x >= limit);
+	return lo + (long long)(x % range);
+}
+
+// Случайное число из интервала (0; 1), чтобы от него можно было брать логарифм
+double uniformOpen(philoxRng& rng)
+{
+	return (double(rng() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Сколько из draws выбранных без повторов номеров диапазона длины population попадёт в его
+// первые good номеров (гипергеометрическое распределение). Малые выборки моделируются точно,
+// большие — нормальным приближением, погрешность которого при таких объёмах пренебрежимо мала.
+long long hypergeometric(philoxRng& rng, long long population, long long good, long long draws)
+{
+	long long lo = max(0LL, draws - (population - good)), hi = min(draws, good);
+
+	if (draws <= 1000)
+	{
+		long long result = 0;
+		for (long long i = 0; i < draws; i++)
+		{
+			if (uniformInt(rng, 0, population - 1 - i) < good - result)
+				result++;
+		}
+		return result;
+	}
+
+	double p = (double)good / population;
+	double mean = draws * p;
+	double variance = mean * (1 - p) * (population - draws) / (population - 1);
+	double normal = sqrt(-2 * log(uniformOpen(rng))) * cos(2 * 3.14159265358979323846 * uniformOpen(rng));
+	long long result = llround(mean + sqrt(variance) * normal);
+	return min(hi, max(lo, result));
+}
+
+// Последовательная выборка Виттера (алгоритм D): выбирает n различных номеров из [0; N)
+// в порядке возрастания за O(n) времени и O(1) памяти, генерируя длину пропуска между
+// соседними выбранными номерами вместо перебора всех N номеров.
+template <typename Select>
+void sequentialSample(long long n, long long N, philoxRng& rng, Select select)
+{
+	const double negAlphaInv = -13; // при n > N / 13 выгоднее простой алгоритм A
+	long long current = 0;
+
+	double nreal = (double)n, Nreal = (double)N, ninv = 1.0 / nreal;
+	double vprime = exp(log(uniformOpen(rng)) * ninv);
+	long long qu1 = -n + 1 + N;
+	double qu1real = -nreal + 1 + Nreal;
+	double threshold = -negAlphaInv * n;
+
+	while (n > 1 && threshold < N)
+	{
+		double nmin1inv = 1.0 / (-1 + nreal);
+		long long S;
+		double negSreal;
+
+		while (true)
+		{
+			double X;
+			while (true)
+			{
+				X = Nreal * (-vprime + 1);
+				S = (long long)X;
+				if (S < qu1) break;
+				vprime = exp(log(uniformOpen(rng)) * ninv);
+			}
+
+			double U = uniformOpen(rng);
+			negSreal = -(double)S;
+			double y1 = exp(log(U * Nreal / qu1real) * nmin1inv);
+			vprime = y1 * (-X / Nreal + 1) * (qu1real / (negSreal + qu1real));
+			if (vprime <= 1) break; // быстрая проверка принятия
+
+			double y2 = 1, top = -1 + Nreal, bottom;
+			long long limit;
+			if (n - 1 > S)
+			{
+				bottom = -nreal + Nreal;
+				limit = -S + N;
+			}
+			else
+			{
+				bottom = -1 + negSreal + Nreal;
+				limit = qu1;
+			}
+			for (long long t = N - 1; t >= limit; t--)
+			{
+				y2 = (y2 * top) / bottom;
+				top--;
+				bottom--;
+			}
+
+			if (Nreal / (-X + Nreal) >= y1 * exp(log(y2) * nmin1inv))
+			{
+				vprime = exp(log(uniformOpen(rng)) * nmin1inv);
+				break;
+			}
+			vprime = exp(log(uniformOpen(rng)) * ninv);
+		}
+
+		current += S;
+		select(current++);
+
+		N = -S + (N - 1);
+		Nreal = negSreal + (-1 + Nreal);
+		n--;
+		nreal--;
+		ninv = nmin1inv;
+		qu1 = -S + qu1;
+		qu1real = negSreal + qu1real;
+		threshold += negAlphaInv;
+	}
+
+	if (n > 1)
+	{
+		// Алгоритм A для плотного остатка
+		double top = (double)(N - n);
+		Nreal = (double)N;
+		while (n >= 2)
+		{
+			double V = uniformOpen(rng), quot = top / Nreal;
+			long long S = 0;
+			while (quot > V)
+			{
+				S++;
+				top--;
+				Nreal--;
+				quot = quot * top / Nreal;
+			}
+			current += S;
+			select(current++);
+			Nreal--;
+			n--;
+		}
+		N = (long long)Nreal;
+	}
+
+	if (n == 1)
+	{
+		long long S = (long long)(N * uniformOpen(rng));
+		current += S;
+		select(current);
+	}
+}
+
+// Участок пространства рёбер [first; first + size), из которого выбирается samples рёбер.
+// node — номер узла в дереве разбиений, он же номер потока Philox для этого участка.
+struct sampleBlock
+{
+	long long first, size, samples;
+	uint64_t node;
+};
+
+const long long blockSamples = 1 << 16; // рёбер в одном участке, который генерируется целиком одним потоком
+const uint64_t splitStreams = 1ULL << 62; // потоки Philox для разбиений отделены от потоков участков
+const uint64_t modelStreams = 1ULL << 61; // потоки участков и рёбер остальных моделей
+const uint64_t weightStreams = 1ULL << 60; // потоки весов, когда поток ребра занят самой моделью
+const uint64_t denseStreams = 1ULL << 59; // потоки весов кусков битовой карты плотного режима
+const long long denseBitsLimit = 1LL << 33; // плотный режим, только если карта не больше 1 ГБ
+const size_t denseChunkWords = 1 << 14; // слов битовой карты в куске, который выдаётся одним потоком
+
+// Делит пространство рёбер пополам, пока на участок не придётся не больше blockSamples рёбер.
+// Разбиение зависит только от seed, поэтому одинаково при любом числе потоков.
+void splitSamples(long long first, long long size, long long samples, uint64_t seed, uint64_t node, vector<sampleBlock>& blocks)
+{
+	if (samples == 0)
+		return;
+
+	if (samples <= blockSamples || size < 2)
+	{
+		blocks.push_back({ first, size, samples, node });
+		return;
+	}
+
+	philoxRng rng(seed, splitStreams | node);
+	long long left = size / 2;
+	long long leftSamples = hypergeometric(rng, size, left, samples);
+
+	splitSamples(first, left, leftSamples, seed, node * 2, blocks);
+	splitSamples(first + left, size - left, samples - leftSamples, seed, node * 2 + 1, blocks);
+}
+
+// Номер первого ребра с началом в вершине row
+long long rowStart(const graphParameters& graph, int vertices, long long row)
+{
+	if (graph.directed)
+		return row * (graph.self_loops ? vertices : vertices - 1);
+	return graph.self_loops ? row * (2LL * vertices - row + 1) / 2 : row * (2LL * vertices - row - 1) / 2;
+}
+
+// Переводит возрастающие номера рёбер, начиная с first, в пары (from, to)
+struct edgeCursor
+{
+	const graphParameters& graph;
+	int vertices, from;
+	long long start, next;
+
+	edgeCursor(const graphParameters& graph, int vertices, long long first) : graph(graph), vertices(vertices)
+	{
+		// Строка пространства рёбер, в которую попадает first
+		int lo = 0, hi = vertices - 1;
+		while (lo < hi)
+		{
+			int mid = lo + (hi - lo + 1) / 2;
+			if (rowStart(graph, vertices, mid) <= first)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+
+		from = lo;
+		start = rowStart(graph, vertices, from);
+		next = rowStart(graph, vertices, from + 1);
+	}
+
+	Edge edge(long long index)
+	{
+		while (index >= next)
+		{
+			from++;
+			start = next;
+			next = rowStart(graph, vertices, from + 1);
+		}
+
+		int offset = (int)(index - start), to;
+		if (graph.directed)
+			to = graph.self_loops ? offset : offset + (offset >= from);
+		else
+			to = graph.self_loops ? from + offset : from + 1 + offset;
+		return { from, to, 0 };
+	}
+};
+
+// Генерирует рёбра одного участка, передавая их в emit по возрастанию номера
+template <typename Emit>
+void sampleBlockEdges(const graphParameters& graph, int vertices, const sampleBlock& block, uint64_t seed, Emit emit)
+{
+	philoxRng rng(seed, block.node);
+	edgeCursor cursor(graph, vertices, block.first);
+
+	sequentialSample(block.samples, block.size, rng, [&](long long index)
+	{
+		Edge edge = cursor.edge(block.first + index);
+		edge.weight = graph.weighted ? (int)uniformInt(rng, graph.Wmin, graph.Wmax) : 0;
+		emit(edge);
+	});
+}
+
+// Общая схема для всех моделей: рёбра делятся на участки, участок b содержит ровно counts[b]
+// рёбер и генерируется вызовом generate(b, out) только по своему потоку Philox. Участки
+// обрабатываются параллельно, но рёбра выдаются строго по порядку участков, поэтому
+// результат побитово одинаков при любом числе потоков.
+// Если задан emit, рёбра передаются в него по порядку и не хранятся целиком в памяти.
+void generateBlocks(const vector<long long>& counts, int threads, const function<void(size_t, Edge*)>& generate,
+	vector<Edge>& edgeList, const function<void(const Edge&)>& emit)
+{
+	if (!emit)
+	{
+		// Смещение каждого участка в итоговом списке известно заранее — потоки пишут сразу на место
+		vector<size_t> offset(counts.size() + 1, edgeList.size());
+		for (size_t b = 0; b < counts.size(); b++)
+			offset[b + 1] = offset[b] + counts[b];
+
+		edgeList.resize(offset.back());
+		parallelFor(0, counts.size(), threads, [&](size_t b) { generate(b, edgeList.data() + offset[b]); });
+		return;
+	}
+
+	// Участки генерируются порциями, а выводятся строго по порядку
+	size_t portion = (size_t)threads * 4;
+	vector<vector<Edge>> buffers(portion);
+	for (size_t first = 0; first < counts.size(); first += portion)
+	{
+		size_t last = min(counts.size(), first + portion);
+		parallelFor(first, last, threads, [&](size_t b)
+		{
+			buffers[b - first].resize(counts[b]);
+			generate(b, buffers[b - first].data());
+		});
+
+		for (size_t b = first; b < last; b++)
+			for (const Edge& edge : buffers[b - first])
+				emit(edge);
+	}
+}
+
+// Равные участки по blockSamples рёбер для моделей, где рёбра генерируются независимо друг от друга
+vector<long long> equalBlocks(long long edges)
+{
+	vector<long long> counts;
+	for (long long first = 0; first < edges; first += blockSamples)
+		counts.push_back(min(blockSamples, edges - first));
+	return counts;
+}
+
+// Случайный граф G(n, m): пространство всех возможных рёбер делится на участки, число рёбер
+// в каждом участке определяется только seed, а внутри участка рёбра выбираются без повторов
+void generateUniform(const graphParameters& graph, int vertices, long long edges, int threads,
+	vector<Edge>& edgeList, const function<void(const Edge&)>& emit)
+{
+	vector<sampleBlock> blocks;
+	splitSamples(0, maxEdges(vertices, graph.directed, graph.self_loops), edges, graph.seed, 1, blocks);
+
+	vector<long long> counts;
+	for (const auto& block : blocks)
+		counts.push_back(block.samples);
+
+	generateBlocks(counts, threads, [&](size_t b, Edge* out)
+	{
+		sampleBlockEdges(graph, vertices, blocks[b], graph.seed, [&](const Edge& edge) { *out++ = edge; });
+	}, edgeList, emit);
+}
+
+// Плотный режим: когда нужно больше половины всех возможных рёбер, выбираются total - edges
+// рёбер, которых в графе не будет, и отмечаются в битовой карте всего пространства рёбер
+// (V x V бит). Граф образуют неотмеченные рёбра, которые выдаются проходом по карте
+// по порядку, поэтому время пропорционально V² и не растёт при приближении к полному графу.
+void generateDense(const graphParameters& graph, int vertices, long long edges, int threads,
+	vector<Edge>& edgeList, const function<void(const Edge&)>& emit)
+{
+	long long total = maxEdges(vertices, graph.directed, graph.self_loops);
+	size_t words = (size_t)((total + 63) / 64);
+	unique_ptr<atomic<uint64_t>[]> excluded(new atomic<uint64_t>[words]());
+
+	// Исключаемые рёбра выбираются так же, как рёбра в разреженном режиме
+	vector<sampleBlock> blocks;
+	splitSamples(0, total, total - edges, graph.seed, 1, blocks);
+	parallelFor(0, blocks.size(), threads, [&](size_t b)
+	{
+		philoxRng rng(graph.seed, blocks[b].node);
+		sequentialSample(blocks[b].samples, blocks[b].size, rng, [&](long long index)
+		{
+			index += blocks[b].first;
+			excluded[index / 64].fetch_or(1ULL << (index % 64), memory_order_relaxed);
+		});
+	});
+
+	// Биты за концом пространства рёбер считаются исключёнными
+	if (total % 64)
+		excluded[words - 1] |= ~0ULL << (total % 64);
+
+	// Карта делится на куски по denseChunkWords слов; число рёбер в куске известно по popcount
+	vector<long long> counts;
+	for (size_t first = 0; first < words; first += denseChunkWords)
+	{
+		size_t last = min(words, first + denseChunkWords);
+		long long count = 0;
+		for (size_t w = first; w < last; w++)
+			count += 64 - bitset<64>(excluded[w].load(memory_order_relaxed)).count();
+		counts.push_back(count);
+	}
+
+	generateBlocks(counts, threads, [&](size_t c, Edge* out)
+	{
+		philoxRng rng(graph.seed, denseStreams | c);
+		size_t first = c * denseChunkWords, last = min(words, first + denseChunkWords);
+		edgeCursor cursor(graph, vertices, (long long)first * 64);
+
+		for (size_t w = first; w < last; w++)
+		{
+			uint64_t present = ~excluded[w].load(memory_order_relaxed);
+			while (present)
+			{
+				int bit = lowestBit(present);
+				present &= present - 1;
+
+				Edge edge = cursor.edge((long long)w * 64 + bit);
+				edge.weight = graph.weighted ? (int)uniformInt(rng, graph.Wmin, graph.Wmax) : 0;
+				*out++ = edge;
+			}
+		}
+	}, edgeList, emit);
+}
+
+// Биекция на [0; 2^scale), перемешивающая номера вершин: иначе вершины R-MAT с большой степенью
+// оказались бы сосредоточены в начале нумерации
+uint64_t scrambleVertex(uint64_t v, int scale, uint64_t seed)
+{
+	uint64_t mask = scale == 64 ? UINT64_MAX : (1ULL << scale) - 1;
+	int shift = max(1, scale / 2);
+	v = (v * 0x9E3779B97F4A7C15ULL + seed) & mask;
+	v ^= v >> shift;
+	v = (v * 0xBF58476D1CE4E5B9ULL + (seed >> 32)) & mask;
+	v ^= v >> shift;
+	return v;
+}
+
+// R-MAT (рекурсивная матрица, частный случай графа Кронекера): каждое ребро спускается по
+// квадрантам матрицы смежности 2^scale x 2^scale с вероятностями a, b, c, d и получается
+// степенное распределение степеней. Как в генераторе Graph500, рёбра независимы,
+// поэтому кратные рёбра возможны.
+void generateRmat(const graphParameters& graph, int vertices, long long edges, int threads,
+	vector<Edge>& edgeList, const function<void(const Edge&)>& emit)
+{
+	int scale = 0;
+	while ((1LL << scale) < vertices)
+		scale++;
+
+	int ab = graph.rmatA + graph.rmatB, abc = ab + graph.rmatC;
+	vector<long long> counts = equalBlocks(edges);
+
+	generateBlocks(counts, threads, [&](size_t b, Edge* out)
+	{
+		philoxRng rng(graph.seed, modelStreams | b);
+		for (long long i = 0; i < counts[b]; i++)
+		{
+			int from, to;
+			do
+			{
+				uint64_t row = 0, col = 0;
+				for (int level = 0; level < scale; level++)
+				{
+					int quadrant = (int)uniformInt(rng, 0, 99);
+					row = row * 2 + (quadrant >= ab);
+					col = col * 2 + ((quadrant >= graph.rmatA && quadrant < ab) || quadrant >= abc);
+				}
+				from = (int)scrambleVertex(row, scale, graph.seed);
+				to = (int)scrambleVertex(col, scale, graph.seed);
+			} while (from >= vertices || to >= vertices || (!graph.self_loops && from == to));
+
+			if (!graph.directed && from > to)
+				swap(from, to);
+
+			int weight = graph.weighted ? (int)uniformInt(rng, graph.Wmin, graph.Wmax) : 0;
+			*out++ = { from, to, weight };
+		}
+	}, edgeList, emit);
+}
+
+// Конец ребра edge в модели предпочтительного присоединения (алгоритм Сандерса и Шульца).
+// Ребро edge выходит из вершины edge / perVertex + 1 и выбирает случайную позицию r среди
+// 2 * edge концов уже созданных рёбер: чётная позиция — начало ребра r / 2, нечётная — конец
+// ребра r / 2, который разрешается так же. Вершина выбирается с вероятностью, пропорциональной
+// её степени, а конец любого ребра вычисляется независимо от остальных.
+int preferentialTarget(const graphParameters& graph, long long edge, int perVertex)
+{
+	while (edge > 0)
+	{
+		int source = (int)(edge / perVertex + 1);
+		philoxRng rng(graph.seed, modelStreams | edge);
+
+		long long r;
+		do
+		{
+			r = uniformInt(rng, 0, 2 * edge - 1);
+		} while (!graph.self_loops && r % 2 == 0 && r / 2 / perVertex + 1 == source);
+
+		if (r % 2 == 0)
+			return (int)(r / 2 / perVertex + 1);
+		edge = r / 2;
+	}
+	return 0;
+}
+
+// Модель Барабаши–Альберт: каждая новая вершина присоединяется perVertex рёбрами
+// к уже существующим вершинам (направление ребра — от новой вершины к старой)
+void generatePreferential(const graphParameters& graph, int perVertex, long long edges, int threads,
+	vector<Edge>& edgeList, const function<void(const Edge&)>& emit)
+{
+	vector<long long> counts = equalBlocks(edges);
+
+	generateBlocks(counts, threads, [&](size_t b, Edge* out)
+	{
+		philoxRng rng(graph.seed, weightStreams | b);
+		for (long long edge = (long long)b * blockSamples, last = edge + counts[b]; edge < last; edge++)
+		{
+			int from = (int)(edge / perVertex + 1), to = preferentialTarget(graph, edge, perVertex);
+			if (!graph.directed && from > to)
+				swap(from, to);
+
+			int weight = graph.weighted ? (int)uniformInt(rng, graph.Wmin, graph.Wmax) : 0;
+			*out++ = { from, to, weight };
+		}
+	}, edgeList, emit);
+}
+
+// Число рёбер решётки dims[0] x dims[1] x dims[2] (для двумерной решётки dims[0] = 1)
+long long latticeEdges(const int dims[3])
+{
+	long long total = 0;
+	for (int d = 0; d < 3; d++)
+		total += (long long)(dims[0] - (d == 0)) * (dims[1] - (d == 1)) * (dims[2] - (d == 2));
+	return total;
+}
+
+// Двумерная или трёхмерная решётка: вершина (x, y, z) имеет номер (x * dims[1] + y) * dims[2] + z
+// и соединена с соседями по каждой оси. В ориентированном графе каждое ребро решётки
+// присутствует в обоих направлениях.
+void generateGrid(const graphParameters& graph, const int dims[3], long long edges, int threads,
+	vector<Edge>& edgeList, const function<void(const Edge&)>& emit)
+{
+	const long long stride[3] = { (long long)dims[1] * dims[2], dims[2], 1 };
+	vector<long long> counts = equalBlocks(edges);
+
+	generateBlocks(counts, threads, [&](size_t b, Edge* out)
+	{
+		philoxRng rng(graph.seed, modelStreams | b);
+		for (long long e = (long long)b * blockSamples, last = e + counts[b]; e < last; e++)
+		{
+			long long index = graph.directed ? e / 2 : e;
+
+			// Ось, вдоль которой идёт ребро, и номер ребра среди рёбер этой оси (ось z первой)
+			int axis = 2;
+			long long axisEdges;
+			while (index >= (axisEdges = (long long)(dims[0] - (axis == 0)) * (dims[1] - (axis == 1)) * (dims[2] - (axis == 2))))
+			{
+				index -= axisEdges;
+				axis--;
+			}
+
+			long long from = 0;
+			for (int d = 2; d >= 0; d--)
+			{
+				long long extent = dims[d] - (d == axis);
+				from += (index % extent) * stride[d];
+				index /= extent;
+			}
+			long long to = from + stride[axis];
+
+			if (graph.directed && e % 2)
+				swap(from, to);
+
+			int weight = graph.weighted ? (int)uniformInt(rng, graph.Wmin, graph.Wmax) : 0;
+			*out++ = { (int)from, (int)to, weight };
+		}
+	}, edgeList, emit);
+}
+
+// Генерирует граф по параметрам graph. Рёбра складываются в edgeList или, если задан emit,
+// по порядку передаются в него и не хранятся в памяти.
+void generateGraph(graphParameters& graph, vector<Edge>& edgeList, int& ver, const function<void(const Edge&)>& emit)
+{
+	philoxRng rng(graph.seed, 0);
+
+	int vertices = (int)uniformInt(rng, graph.Vmin, graph.Vmax);
+	long long edges = uniformInt(rng, graph.Emin, graph.Emax);
+	int threads = threadCount(graph.threads);
+	long long total = maxEdges(vertices, graph.directed, graph.self_loops);
+	int perVertex = 1, dims[3] = { 1, 1, 1 };
+
+	// Число вершин и рёбер уточняется моделью
+	switch (graph.model)
+	{
+	case rmatModel:
+		if (vertices < 2 && !graph.self_loops)
+			edges = 0;
+		break;
+	case preferentialModel:
+		perVertex = (int)max(1LL, edges / max(vertices, 1));
+		edges = vertices > 1 ? (long long)(vertices - 1) * perVertex : 0;
+		break;
+	case grid2dModel:
+		dims[1] = max(1, (int)sqrt((double)vertices));
+		dims[2] = vertices / dims[1];
+		break;
+	case grid3dModel:
+		dims[0] = max(1, (int)cbrt((double)vertices));
+		dims[1] = max(1, (int)sqrt((double)vertices / dims[0]));
+		dims[2] = vertices / (dims[0] * dims[1]);
+		break;
+	default:
+		edges = min(edges, total);
+		break;
+	}
+
+	if (graph.model == grid2dModel || graph.model == grid3dModel)
+	{
+		vertices = dims[0] * dims[1] * dims[2];
+		edges = latticeEdges(dims) * (graph.directed ? 2 : 1);
+	}
+
+	ver = vertices;
+	cout << "Количество вершин: " << vertices << "\tКоличество рёбер: " << edges << "\tseed: " << graph.seed;
+
+	if (edges <= 0)
+		return;
+
+	switch (graph.model)
+	{
+	case rmatModel:
+		generateRmat(graph, vertices, edges, threads, edgeList, emit);
+		break;
+	case preferentialModel:
+		generatePreferential(graph, perVertex, edges, threads, edgeList, emit);
+		break;
+	case grid2dModel:
+	case grid3dModel:
+		generateGrid(graph, dims, edges, threads, edgeList, emit);
+		break;
+	default:
+		if (edges > total / 2 && total <= denseBitsLimit)
+			generateDense(graph, vertices, edges, threads, edgeList, emit);
+		else
+			generateUniform(graph, vertices, edges, threads, edgeList, emit);
+		break;
+	}
+
+	if (graph.sortedByWeight && !emit && graph.weighted)
+	{
+		// Корзин не больше, чем рёбер, иначе раскладка теряет смысл и выгоднее обычная сортировка
+		if ((long long)graph.Wmax - graph.Wmin < max(edges, 1LL << 16))
+			bucketSortByWeight(edgeList, graph.Wmin, graph.Wmax);
+		else
+			stable_sort(edgeList.begin(), edgeList.end(), [](const Edge& a, const Edge& b) { return a.weight < b.weight; });
+	}
+}
+
+// Запись графа в matrix.txt и list.txt в фоновом потоке. Список рёбер должен оставаться
+// неизменным, пока не завершится возвращённая задача.
+future<void> saveGraphAsync(const vector<Edge>& edgeList, int vertices, const graphParameters& graph)
+{
+	return async(launch::async, [&edgeList, vertices, graph]()
+	{
+		string matrixFile = "matrix.txt", listFile = "list.txt", binaryFile = "graph.bin";
+
+		savedAdjacencyMatrix(edgeList, vertices, graph.directed, graph.weighted, matrixFile, graph.threads);
+
+		savedAdjacencyList(edgeList, vertices, graph.directed, graph.weighted, listFile, graph.threads);
+
+		savedBinaryGraph(edgeList, vertices, graph.directed, graph.weighted, binaryFile);
+	});
+}
@@ -3,10 +3,19 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <string>
 #include <ctime>
-#include <set>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+#include <future>
+#include <memory>
 using namespace std;
 
+// Общая библиотека графов для всех программ: описание и чтение параметров, генерация,
+// сохранение в файлы и компактное представление графа в формате CSR.
+
 struct Edge
 {
 	int from;
@@ -14,17 +23,380 @@ struct Edge
 	int weight;
 };
 
+// Модель случайного графа
+enum graphModel
+{
+	uniformModel = 0,      // равномерный случайный граф G(n, m)
+	rmatModel = 1,         // R-MAT / Кронекер, степенное распределение степеней
+	preferentialModel = 2, // предпочтительное присоединение (Барабаши–Альберт)
+	grid2dModel = 3,       // двумерная решётка
+	grid3dModel = 4        // трёхмерная решётка
+};
+
 struct graphParameters
 {
 	int directed, weighted, self_loops;
 	int Vmin, Vmax, Emin, Emax;
 	int Wmin = 0, Wmax = 0;
+	uint64_t seed = 0; // зерно генератора: один и тот же seed даёт один и тот же граф
+	int threads = 0;   // число потоков, 0 — по числу ядер
+	int model = uniformModel;
+	int rmatA = 57, rmatB = 19, rmatC = 19; // вероятности квадрантов R-MAT в процентах, d = 100 - a - b - c
+	int sortedByWeight = 0; // упорядочить сгенерированные рёбра по весу
+};
+
+// Дуга при обходе соседей: вершина и вес (1 для невзвешенного графа, как в матрице смежности)
+struct arc
+{
+	uint32_t target;
+	int weight;
+};
+
+// Обход соседей вершины: for (arc a : g.neighbors(v)). Одинаков для CSR и сжатых списков,
+// поэтому алгоритмы-шаблоны работают с любым из представлений
+template <typename Iterator>
+struct arcRange
+{
+	Iterator first, last;
+
+	Iterator begin() const { return first; }
+	Iterator end() const { return last; }
+};
+
+struct csrArcIterator
+{
+	const uint32_t* target;
+	const int* weight; // nullptr для невзвешенного графа
+
+	arc operator*() const { return { *target, weight ? *weight : 1 }; }
+	csrArcIterator& operator++()
+	{
+		target++;
+		if (weight) weight++;
+		return *this;
+	}
+	bool operator!=(const csrArcIterator& other) const { return target != other.target; }
+};
+
+// Граф в формате CSR (compressed sparse row): соседи вершины v лежат подряд
+// в targets[offsets[v]; offsets[v + 1]), веса дуг — в weights с теми же индексами.
+// Для неориентированного графа каждое ребро хранится двумя дугами.
+// Сам граф только ссылается на массивы: ими владеет storage — буферы в памяти (csrBuffers)
+// или отображённый в память двоичный файл, поэтому копия графа ничего не копирует.
+struct csrGraph
+{
+	int vertices = 0;
+	int weighted = 0;
+	size_t arcCount = 0;
+	const uint32_t* offsets = nullptr; // vertices + 1 элементов
+	const uint32_t* targets = nullptr;
+	const int* weights = nullptr;      // nullptr для невзвешенного графа
+	shared_ptr<const void> storage;
+
+	uint32_t begin(int v) const { return offsets[v]; }
+	uint32_t end(int v) const { return offsets[v + 1]; }
+	uint32_t degree(int v) const { return offsets[v + 1] - offsets[v]; }
+	size_t arcs() const { return arcCount; }
+
+	arcRange<csrArcIterator> neighbors(int v) const
+	{
+		return { { targets + offsets[v], weights ? weights + offsets[v] : nullptr },
+		         { targets + offsets[v + 1], weights ? weights + offsets[v + 1] : nullptr } };
+	}
+
+	// Транспонированный граф (все дуги развёрнуты), строится по запросу
+	csrGraph transposed() const;
+};
+
+// Массивы CSR в памяти: заполняются при построении, затем передаются графу через makeCsr
+struct csrBuffers
+{
+	vector<uint32_t> offsets;
+	vector<uint32_t> targets;
+	vector<int> weights;
+};
+
+csrGraph makeCsr(int vertices, int weighted, shared_ptr<csrBuffers> buffers);
+
+// Беззнаковое число в varint: по 7 бит в байте начиная с младших, старший бит — продолжение.
+// Короткие разности (один байт) разбираются первой веткой без цикла
+inline uint64_t readVarint(const uint8_t*& p)
+{
+	uint64_t value = *p++;
+	if (value < 0x80)
+		return value;
+	value &= 0x7F;
+	for (int shift = 7;; shift += 7)
+	{
+		uint8_t byte = *p++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if (byte < 0x80)
+			return value;
+	}
+}
+
+// Знаковое число в беззнаковом виде: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+inline uint64_t zigzag(long long value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+inline long long unzigzag(uint64_t value) { return (long long)(value >> 1) ^ -(long long)(value & 1); }
+
+struct compressedArcIterator
+{
+	const uint8_t* p;
+	uint32_t left;  // сколько дуг осталось, включая текущую
+	int weighted;
+	arc current;
+
+	compressedArcIterator(const uint8_t* p, uint32_t count, int v, int weighted) : p(p), left(count), weighted(weighted), current{ 0, 1 }
+	{
+		if (left)
+			decode((long long)v + unzigzag(readVarint(this->p)));
+	}
+
+	void decode(long long target)
+	{
+		current.target = (uint32_t)target;
+		if (weighted)
+			current.weight = (int)unzigzag(readVarint(p));
+	}
+
+	arc operator*() const { return current; }
+	compressedArcIterator& operator++()
+	{
+		if (--left)
+			decode((long long)current.target + (long long)readVarint(p));
+		return *this;
+	}
+	bool operator!=(const compressedArcIterator& other) const { return left != other.left; }
+};
+
+// Сжатые списки смежности для очень больших графов. Соседи вершины упорядочены по номеру
+// и записаны разностями в varint: число соседей, первый сосед — знаковой разностью с v, затем
+// разности между соседними номерами; у взвешенного графа за каждой разностью следует вес.
+// Начало списка вершины v — blockStart[v / 64] + vertexStart[v]: индекс занимает 4 байта
+// на вершину и 8 байт на блок из 64 вершин. Массивы, как и в csrGraph, принадлежат storage.
+struct compressedGraph
+{
+	int vertices = 0;
+	int weighted = 0;
+	size_t arcCount = 0;
+	size_t byteCount = 0;
+	const uint64_t* blockStart = nullptr; // (vertices + 63) / 64 элементов
+	const uint32_t* vertexStart = nullptr;
+	const uint8_t* bytes = nullptr;
+	shared_ptr<const void> storage;
+
+	const uint8_t* list(int v) const { return bytes + blockStart[v / 64] + vertexStart[v]; }
+	size_t arcs() const { return arcCount; }
+	uint32_t degree(int v) const
+	{
+		const uint8_t* p = list(v);
+		return (uint32_t)readVarint(p);
+	}
+
+	arcRange<compressedArcIterator> neighbors(int v) const
+	{
+		const uint8_t* p = list(v);
+		uint32_t count = (uint32_t)readVarint(p);
+		return { compressedArcIterator(p, count, v, weighted), compressedArcIterator(p, 0, v, weighted) };
+	}
+
+	// Объём массивов в байтах
+	size_t memoryBytes() const { return byteCount + (size_t)vertices * 4 + ((size_t)vertices + 63) / 64 * 8; }
+
+	compressedGraph transposed(int threads = 0) const;
+};
+
+compressedGraph compressGraph(const csrGraph& g, int threads = 0);
+
+// Номер младшего и старшего единичного бита (x != 0) и число единичных битов
+int lowestBit(uint64_t x);
+
+int highestBit(uint64_t x);
+
+int bitCount(uint64_t x);
+
+// Обход единичных битов строки битовой матрицы: соседи идут по возрастанию номера, вес 1.
+// rest — ещё не выданные биты слова word; у конечного итератора word == words
+struct bitArcIterator
+{
+	const uint64_t* row;
+	size_t word, words;
+	uint64_t rest;
+
+	bitArcIterator(const uint64_t* row, size_t word, size_t words) : row(row), word(word), words(words), rest(word < words ? row[word] : 0)
+	{
+		skip();
+	}
+
+	void skip()
+	{
+		while (!rest && word < words && ++word < words)
+			rest = row[word];
+	}
+
+	arc operator*() const { return { (uint32_t)(word * 64 + lowestBit(rest)), 1 }; }
+	bitArcIterator& operator++()
+	{
+		rest &= rest - 1;
+		skip();
+		return *this;
+	}
+	bool operator!=(const bitArcIterator& other) const { return word != other.word || rest != other.rest; }
 };
 
+// Матрица смежности невзвешенного графа по биту на ячейку: строка v занимает rowWords
+// 64-битных слов подряд, бит j слова w — дуга v -> 64 * w + j. В 32 раза меньше матрицы int.
+struct bitMatrix
+{
+	int vertices = 0;
+	size_t rowWords = 0;
+	vector<uint64_t> bits;
+
+	bitMatrix() {}
+	explicit bitMatrix(int vertices);
+
+	const uint64_t* row(int v) const { return bits.data() + v * rowWords; }
+	bool get(int u, int v) const { return (bits[u * rowWords + v / 64] >> (v % 64)) & 1; }
+	void set(int u, int v) { bits[u * rowWords + v / 64] |= 1ull << (v % 64); }
+
+	// Соседи — единичные биты строки, так что алгоритмы-шаблоны работают и с матрицей
+	arcRange<bitArcIterator> neighbors(int v) const
+	{
+		return { bitArcIterator(row(v), 0, rowWords), bitArcIterator(row(v), rowWords, rowWords) };
+	}
+
+	int degree(int v) const;                 // число соседей — popcount строки
+	int commonNeighbors(int u, int v) const; // число общих соседей — popcount пересечения строк
+	bitMatrix transposed(int threads = 0) const;
+};
+
+// Перестановка вершин для лучшей локальности: newId[v] — номер исходной вершины v
+// в переупорядоченном графе, oldId — обратная перестановка. Пустая перестановка — тождественная.
+// Алгоритмы работают с новыми номерами, а результаты выводятся в исходных через original.
+struct vertexPermutation
+{
+	vector<int> newId, oldId;
+
+	int original(int v) const { return oldId.empty() ? v : oldId[v]; }
+	int renamed(int v) const { return newId.empty() ? v : newId[v]; }
+};
+
+enum vertexOrder
+{
+	originalOrder = 0, // исходные номера
+	degreeOrder = 1,   // по убыванию степени
+	rcmOrder = 2,      // обратный алгоритм Катхилла–Макки
+	bfsOrder = 3       // порядок обхода в ширину
+};
+
+// Счётчиковый генератор Philox4x32-10: k-е число потока зависит только от seed, номера потока
+// и k, поэтому любой участок генерации можно воспроизвести в любом потоке и в любом порядке
+struct philoxRng
+{
+	uint32_t key0, key1;
+	uint64_t stream, counter = 0;
+	uint32_t block[4];
+	int used = 4;
+
+	philoxRng(uint64_t seed, uint64_t stream) : key0((uint32_t)seed), key1((uint32_t)(seed >> 32)), stream(stream) {}
+
+	uint64_t operator()()
+	{
+		if (used == 4)
+		{
+			nextBlock();
+			used = 0;
+		}
+		uint64_t value = ((uint64_t)block[used] << 32) | block[used + 1];
+		used += 2;
+		return value;
+	}
+
+	void nextBlock();
+};
+
+// Случайное целое из [lo; hi] без смещения (не зависит от реализации стандартной библиотеки)
+long long uniformInt(philoxRng& rng, long long lo, long long hi);
+
+// Число потоков: заданное или по числу ядер
+int threadCount(int threads);
+
+// Выполняет body(i) для всех i из [first; last) в threads потоках
+void parallelFor(size_t first, size_t last, int threads, const function<void(size_t)>& body);
+
 void readData(string path, graphParameters& graph);
 
-void savedAdjacencyList(vector<Edge> edgeList, int vertices, int directed, int weighted, string path);
+vector<vector<int>> buildAdjacencyMatrix(const vector<Edge>& edgeList, int vertices, int directed, int weighted);
+
+vector<vector<int>> buildAdjacencyMatrix(const csrGraph& g);
+
+csrGraph buildCsr(const vector<Edge>& edgeList, int vertices, int directed, int weighted, int threads = 0);
+
+// Буфер текста: числа форматируются через to_chars, в поток уходят одним крупным блоком
+struct textBuffer
+{
+	string data;
+
+	void put(long long value);
+	void put(int value) { put((long long)value); }
+	void put(uint32_t value) { put((long long)value); }
+	void put(char c) { data.push_back(c); }
+	void put(const char* text) { data.append(text); }
+	void writeTo(ostream& out);
+};
+
+// Текстовые файлы графа; участки файла форматируются в threads потоках и пишутся по порядку
+void savedAdjacencyList(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path, int threads = 0);
+
+void savedAdjacencyMatrix(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path, int threads = 0);
+
+// Параллельное чтение списка смежности, записанного savedAdjacencyList
+csrGraph readAdjacencyList(string path, int threads = 0);
+
+// Параллельное чтение матрицы смежности, записанной savedAdjacencyMatrix, сразу в CSR
+csrGraph readAdjacencyMatrix(string path, int threads = 0);
+
+// Матрица смежности в формате Matrix Market (coordinate) — только ненулевые ячейки
+void savedMatrixMarket(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path, int threads = 0);
+
+// Двоичный файл графа: CSR-массивы записываются как есть и при открытии отображаются в память
+void savedBinaryGraph(const csrGraph& g, int directed, string path);
+
+void savedBinaryGraph(const vector<Edge>& edgeList, int vertices, int directed, int weighted, string path);
+
+csrGraph openBinaryGraph(string path, int& directed);
+
+// Тот же двоичный файл со сжатыми списками вместо массивов CSR
+void savedCompressedGraph(const compressedGraph& g, int directed, string path);
+
+compressedGraph openCompressedGraph(string path, int& directed);
+
+void savedEdgeList(const vector<Edge>& edgeList, int directed, int weighted, bool sorted, string path, int threads = 0);
+
+void readEdgeList(vector<Edge>& edgeList, int& vertices, bool& sorted, string path);
+
+bitMatrix buildBitMatrix(const vector<Edge>& edgeList, int vertices, int directed);
+
+bitMatrix buildBitMatrix(const csrGraph& g);
+
+void savedBitMatrix(const bitMatrix& m, string path, int threads = 0);
+
+bitMatrix readBitMatrix(string path);
+
+vertexPermutation computeOrder(const csrGraph& g, int order);
+
+csrGraph permuteGraph(const csrGraph& g, const vertexPermutation& p, int threads = 0);
+
+void permuteEdges(vector<Edge>& edgeList, const vertexPermutation& p);
+
+// Запускает run на графе в каждом из порядков вершин и печатает время перестановки и алгоритма,
+// а также долю дуг, ведущих дальше 16 номеров (в другую кэш-линию массива int по вершинам)
+void benchmarkOrders(const csrGraph& g, int threads, const function<void(const csrGraph&, const vertexPermutation&)>& run);
+
+long long maxEdges(int vertices, int directed, int self_loops);
+
+void bucketSortByWeight(vector<Edge>& edgeList, int Wmin, int Wmax);
 
-void savedAdjacencyMatrix(vector<Edge>& edgeList, int vertices, int directed, int weighted, string path);
+void generateGraph(graphParameters& graph, vector<Edge>& edgeList, int& vertices, const function<void(const Edge&)>& emit = nullptr);
 
-void generateGraph(int& vertices);
\ No newline at end of file
+future<void> saveGraphAsync(const vector<Edge>& edgeList, int vertices, const graphParameters& graph);
@@ -1,154 +1,930 @@
 ﻿#include <iostream>
 #include <fstream>
 #include <queue>
-#include <sstream>
 #include <vector>
 #include <limits> 
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "initGraph.h"
 using namespace std;
 
-void readAdjacencyList(vector<vector<pair<int, int>>>& adjList, int vertices, string fileName) {
-    ifstream inFile(fileName);
-    if (!inFile)
+// Очереди с приоритетом для алгоритма Дейкстры. Общий интерфейс: push(v, key) добавляет
+// вершину или уменьшает её ключ, pop() возвращает вершину с наименьшим ключом;
+// stats считает операции, наибольший размер очереди и занимаемую память
+struct queueStats
+{
+    size_t pushes = 0, decreases = 0, pops = 0, peak = 0, bytes = 0;
+};
+
+enum queueKind
+{
+    lazyBinaryQueue = 0, // двоичная куча с повторными записями вместо уменьшения ключа
+    fourAryQueue = 1,    // индексированная 4-арная куча
+    radixQueue = 2,      // монотонная поразрядная куча, только для неотрицательных весов
+    dialQueue = 3        // корзины Дайала, для малых неотрицательных весов
+};
+
+// Наибольший вес, при котором очередь выбирается корзинами Дайала
+const int dialWeightLimit = 4096;
+
+// Двоичная куча priority_queue с ленивым удалением: уменьшение ключа — новая запись,
+// устаревшие записи извлекаются и пропускаются алгоритмом; размер кучи до O(E)
+struct lazyBinaryHeap
+{
+    priority_queue<pair<int, int>> q;
+    queueStats stats;
+
+    explicit lazyBinaryHeap(int) {}
+
+    bool empty() const { return q.empty(); }
+
+    void push(int v, int k)
+    {
+        q.push({ -k, v });
+        stats.pushes++;
+        stats.peak = max(stats.peak, q.size());
+        stats.bytes = stats.peak * sizeof(pair<int, int>);
+    }
+
+    int pop()
     {
-        cerr << "\nОшибка при открытии файла: " << fileName << "\n";
-        exit(1);
+        int v = q.top().second;
+        q.pop();
+        stats.pops++;
+        return v;
     }
+};
+
+// Индексированная 4-арная куча: позиция каждой вершины в куче известна, поэтому ключ
+// уменьшается на месте просеиванием вверх, а в куче не больше V вершин. Ключи хранятся
+// в самой куче рядом с вершинами, четыре потомка лежат подряд, а высота кучи вдвое
+// меньше двоичной
+struct fourAryHeap
+{
+    vector<pair<int, int>> heap; // ключ и вершина
+    vector<int> position;
+    queueStats stats;
 
-    adjList.resize(vertices); // Инициализируем вектор для хранения смежностей
+    explicit fourAryHeap(int vertices) : position(vertices, -1) {}
 
-    string line;
-    int vertex;
+    bool empty() const { return heap.empty(); }
 
-    while (getline(inFile, line))
+    void push(int v, int k)
     {
-        if (line.empty()) continue; // Пропуск пустых строк
+        if (position[v] < 0)
+        {
+            position[v] = (int)heap.size();
+            heap.push_back({ k, v });
+            stats.pushes++;
+            stats.peak = max(stats.peak, heap.size());
+            stats.bytes = stats.peak * sizeof(pair<int, int>) + position.size() * sizeof(int);
+        }
+        else
+        {
+            heap[position[v]].first = k;
+            stats.decreases++;
+        }
+        siftUp(position[v]);
+    }
 
-        stringstream ss(line);
-        ss >> vertex; // Читаем номер вершины
-        char colon;
-        ss >> colon; // Читаем символ ':'
+    int pop()
+    {
+        int v = heap[0].second;
+        position[v] = -1;
+        stats.pops++;
+        pair<int, int> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return v;
+    }
 
-        if (ss.fail() || colon != ':') {
-            cerr << "Ошибка: некорректный формат строки: " << line << "\n";
-            exit(1);
+    void siftUp(int i)
+    {
+        pair<int, int> item = heap[i];
+        while (i > 0)
+        {
+            int parent = (i - 1) / 4;
+            if (heap[parent].first <= item.first)
+                break;
+            heap[i] = heap[parent];
+            position[heap[i].second] = i;
+            i = parent;
         }
+        heap[i] = item;
+        position[item.second] = i;
+    }
 
-        // Читаем пары вида (сосед, вес)
-        char openBracket, closeBracket, comma;
-        int neighbor, weight;
-        while (ss >> openBracket >> neighbor >> comma >> weight >> closeBracket) 
+    void siftDown(int i)
+    {
+        pair<int, int> item = heap[i];
+        int size = (int)heap.size();
+        while (true)
         {
-            if (openBracket != '(' || comma != ',' || closeBracket != ')') {
-                cerr << "Ошибка: некорректный формат пары в строке: " << line << "\n";
-                exit(1);
+            int first = 4 * i + 1, best = i, bestKey = item.first;
+            for (int c = first; c < min(first + 4, size); c++)
+            {
+                if (heap[c].first < bestKey)
+                {
+                    best = c;
+                    bestKey = heap[c].first;
+                }
             }
-            adjList[vertex].emplace_back(neighbor, weight); // Добавляем (сосед, вес) в список
+            if (best == i)
+                break;
+            heap[i] = heap[best];
+            position[heap[i].second] = i;
+            i = best;
         }
+        heap[i] = item;
+        position[item.second] = i;
+    }
+};
 
-        if (!ss.eof() && ss.fail()) {
-            cerr << "Ошибка: некорректный формат строки: " << line << "\n";
-            exit(1);
-        }
+// Монотонная поразрядная куча: ключи не меньше последнего извлечённого last, вершина
+// с ключом k лежит в корзине номер «старший различающийся бит k и last». Извлечение
+// из пустой нулевой корзины находит минимум первой непустой и раскладывает её по
+// младшим корзинам — каждая вершина опускается не больше 32 раз. Уменьшение ключа
+// переносит вершину между корзинами за O(1), в куче не больше V вершин
+struct radixHeap
+{
+    vector<int> buckets[33];
+    vector<int> bucketOf, slot;
+    vector<unsigned> key;
+    unsigned last = 0;
+    size_t size = 0;
+    queueStats stats;
+
+    explicit radixHeap(int vertices) : bucketOf(vertices, -1), slot(vertices), key(vertices) {}
+
+    bool empty() const { return size == 0; }
+
+    int bucketFor(unsigned k) const { return k == last ? 0 : highestBit(k ^ last) + 1; }
+
+    void place(int v)
+    {
+        int b = bucketFor(key[v]);
+        bucketOf[v] = b;
+        slot[v] = (int)buckets[b].size();
+        buckets[b].push_back(v);
     }
 
-    inFile.close();
-}
+    void remove(int v)
+    {
+        vector<int>& bucket = buckets[bucketOf[v]];
+        int moved = bucket.back();
+        bucket[slot[v]] = moved;
+        slot[moved] = slot[v];
+        bucket.pop_back();
+        bucketOf[v] = -1;
+    }
 
+    void push(int v, int k)
+    {
+        if (bucketOf[v] >= 0)
+        {
+            remove(v);
+            stats.decreases++;
+        }
+        else
+        {
+            size++;
+            stats.pushes++;
+            stats.peak = max(stats.peak, size);
+            stats.bytes = stats.peak * sizeof(int) + key.size() * 3 * sizeof(int);
+        }
+        key[v] = (unsigned)k;
+        place(v);
+    }
 
-void readAdjacencyMatrix(vector<vector<int>>& adjMatrix, int vertices, string fileName)
+    int pop()
+    {
+        if (buckets[0].empty())
+        {
+            int b = 1;
+            while (buckets[b].empty())
+                b++;
+            unsigned smallest = numeric_limits<unsigned>::max();
+            for (int v : buckets[b])
+                smallest = min(smallest, key[v]);
+            last = smallest;
+            vector<int> moving;
+            moving.swap(buckets[b]);
+            for (int v : moving)
+                place(v);
+        }
+        int v = buckets[0].back();
+        buckets[0].pop_back();
+        bucketOf[v] = -1;
+        size--;
+        stats.pops++;
+        return v;
+    }
+};
+
+// Корзины Дайала: ключи в очереди лежат в отрезке [current, current + maxWeight], поэтому
+// maxWeight + 1 корзин по кругу хватает, чтобы в каждой были вершины с одним ключом.
+// Извлечение сдвигает current до непустой корзины — корзины просматриваются подряд,
+// за весь алгоритм не больше чем на V · maxWeight шагов. Уменьшение ключа переносит
+// вершину между корзинами за O(1)
+struct bucketQueue
 {
-    ifstream inFile(fileName);
-    if (!inFile) 
+    vector<vector<int>> buckets;
+    vector<int> bucketOf, slot;
+    long long current = 0;
+    size_t size = 0;
+    queueStats stats;
+
+    bucketQueue(int vertices, int maxWeight) : buckets(maxWeight + 1), bucketOf(vertices, -1), slot(vertices) {}
+
+    bool empty() const { return size == 0; }
+
+    void push(int v, int k)
     {
-        cerr << "\nОшибка при открытии файла: " << fileName << "\n";
-        exit(1);
+        if (bucketOf[v] >= 0)
+        {
+            vector<int>& bucket = buckets[bucketOf[v]];
+            int moved = bucket.back();
+            bucket[slot[v]] = moved;
+            slot[moved] = slot[v];
+            bucket.pop_back();
+            stats.decreases++;
+        }
+        else
+        {
+            size++;
+            stats.pushes++;
+            stats.peak = max(stats.peak, size);
+            stats.bytes = stats.peak * sizeof(int) + bucketOf.size() * 2 * sizeof(int) + buckets.size() * sizeof(vector<int>);
+        }
+        int b = (int)(k % (long long)buckets.size());
+        bucketOf[v] = b;
+        slot[v] = (int)buckets[b].size();
+        buckets[b].push_back(v);
     }
 
-    adjMatrix.resize(vertices, vector<int>(vertices, 0)); // Инициализируем матрицу
+    int pop()
+    {
+        size_t b = (size_t)(current % (long long)buckets.size());
+        while (buckets[b].empty())
+        {
+            current++;
+            if (++b == buckets.size())
+                b = 0;
+        }
+        int v = buckets[b].back();
+        buckets[b].pop_back();
+        bucketOf[v] = -1;
+        size--;
+        stats.pops++;
+        return v;
+    }
+};
 
-    for (int i = 0; i < vertices; i++) 
+// Наименьший и наибольший вес дуг (у невзвешенного графа все веса 1)
+template <typename Graph>
+pair<int, int> weightRange(const Graph& g)
+{
+    int smallest = numeric_limits<int>::max(), largest = numeric_limits<int>::min();
+    for (int v = 0; v < g.vertices; v++)
     {
-        for (int j = 0; j < vertices; j++)
+        for (arc e : g.neighbors(v))
         {
-            inFile >> adjMatrix[i][j];
+            smallest = min(smallest, e.weight);
+            largest = max(largest, e.weight);
         }
     }
-    inFile.close();
+    return smallest > largest ? make_pair(0, 0) : make_pair(smallest, largest);
 }
 
-void dijkstra(const vector<vector<pair<int, int>>>& adjList, vector<int>& distance, int vertices, int startVer)
+// Очередь по диапазону весов: при малых весах — корзины Дайала, иначе поразрядная куча.
+// Алгоритм Дейкстры верен только для неотрицательных весов, поэтому граф с отрицательными
+// весами сначала перевзвешивается по потенциалам Джонсона (johnsonPotentials, reweightGraph)
+int chooseQueue(int, int maxWeight)
+{
+    return maxWeight <= dialWeightLimit ? dialQueue : radixQueue;
+}
+
+// Graph — csrGraph или compressedGraph: соседи перебираются через neighbors(v)
+template <typename Graph, typename Queue>
+queueStats dijkstraWith(const Graph& g, vector<int>& distance, int vertices, int startVer, Queue q)
 {
-    priority_queue<pair<int, int>> q;
     vector<bool> processed(vertices, false);
 
     distance.assign(vertices, numeric_limits<int>::max());
     distance[startVer] = 0;
 
-    q.push({ 0, startVer });
+    q.push(startVer, 0);
     while (!q.empty()) 
     {
-        int a = q.top().second;
-        q.pop();
-
+        int a = q.pop();
         if (processed[a]) continue;
         processed[a] = true;
 
-        for (auto u : adjList[a]) 
+        for (arc e : g.neighbors(a)) 
         {
-            int b = u.first, w = u.second;
+            int b = e.target, w = e.weight; // вес 1 у невзвешенного графа, как в матрице смежности
             if (distance[a] + w < distance[b]) 
             {
                 distance[b] = distance[a] + w;
-                q.push({ -distance[b], b });
+                q.push(b, distance[b]);
             }
         }
     }
+    return q.stats;
 }
 
-void floydWarshall(const vector<vector<int>> adjMatrix, vector<vector<int>>& distance, int vertices)
+// Очередь выбирается при вызове; поразрядной куче и корзинам нужны неотрицательные веса,
+// корзинам — ещё и наибольший вес (если он не передан, он находится просмотром дуг)
+template <typename Graph>
+queueStats dijkstra(const Graph& g, vector<int>& distance, int vertices, int startVer, int kind = lazyBinaryQueue,
+    int maxWeight = -1)
+{
+    if (kind == fourAryQueue)
+        return dijkstraWith(g, distance, vertices, startVer, fourAryHeap(vertices));
+    if (kind == radixQueue)
+        return dijkstraWith(g, distance, vertices, startVer, radixHeap(vertices));
+    if (kind == dialQueue)
+        return dijkstraWith(g, distance, vertices, startVer,
+            bucketQueue(vertices, maxWeight < 0 ? weightRange(g).second : maxWeight));
+    return dijkstraWith(g, distance, vertices, startVer, lazyBinaryHeap(vertices));
+}
+
+// Сравнение очередей на одном графе: время, операции и наибольший размер очереди
+template <typename Graph>
+void benchmarkQueues(const Graph& g, int vertices, int startVer, pair<int, int> weights)
+{
+    const char* names[] = { "двоичная куча (ленивое удаление)", "4-арная куча", "поразрядная куча", "корзины Дайала" };
+    vector<int> reference, distance;
+    cout << "\n";
+    for (int kind = lazyBinaryQueue; kind <= dialQueue; kind++)
+    {
+        if ((kind == radixQueue || kind == dialQueue) && weights.first < 0)
+        {
+            cout << names[kind] << ": пропущена, в графе есть отрицательные веса\n";
+            continue;
+        }
+        if (kind == dialQueue && weights.second > (1 << 24))
+        {
+            cout << names[kind] << ": пропущена, слишком большой наибольший вес\n";
+            continue;
+        }
+        auto startTime = chrono::steady_clock::now();
+        queueStats stats = dijkstra(g, distance, vertices, startVer, kind, weights.second);
+        double time = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        if (kind == lazyBinaryQueue)
+            reference = distance;
+
+        size_t relaxations = stats.pushes + stats.decreases;
+        cout << names[kind] << ": " << time * 1e3 << " мс, вставок " << stats.pushes << ", уменьшений ключа "
+             << stats.decreases << ", извлечений " << stats.pops << ", операций на релаксацию "
+             << (relaxations ? (double)(relaxations + stats.pops) / relaxations : 0) << ", наибольший размер "
+             << stats.peak << ", память " << stats.bytes / 1024.0 << " КБ"
+             << (distance == reference ? "" : ", РАССТОЯНИЯ РАЗЛИЧАЮТСЯ") << "\n";
+    }
+}
+
+// Ширина корзины Δ по диапазону весов: примерно столько, чтобы из каждой вершины в среднем
+// вела одна лёгкая дуга (вес не больше Δ), но не меньше наименьшего веса
+int defaultDelta(int minWeight, int maxWeight, int vertices, size_t arcs)
+{
+    size_t degree = max<size_t>(1, arcs / max(1, vertices));
+    return max({ 1, minWeight, (int)(maxWeight / degree) });
+}
+
+// Параллельный Δ-шаговый алгоритм (Мейер и Сандерс) для неотрицательных весов. Вершины
+// лежат в корзинах по floor(расстояние / Δ); корзины идут по кругу, их maxWeight / Δ + 2.
+// Наименьшая непустая корзина обрабатывается фазами: лёгкие дуги её вершин релаксируются
+// параллельно, улучшенные вершины попадают в корзины, пока текущая не опустеет; затем
+// один раз релаксируются тяжёлые дуги всех вершин, прошедших через корзину. Расстояния
+// уменьшаются атомарным минимумом, поэтому результат совпадает с алгоритмом Дейкстры.
+// Небольшие фронты обрабатываются в одном потоке — запуск потоков дороже самой работы
+template <typename Graph>
+void deltaStepping(const Graph& g, vector<int>& distance, int vertices, int startVer, int delta, int maxWeight, int threads)
 {
     const int INF = numeric_limits<int>::max();
-    distance.assign(vertices, vector<int>(vertices, INF));
+    threads = threadCount(threads);
+    vector<atomic<int>> dist(vertices);
+    for (auto& d : dist)
+        d.store(INF, memory_order_relaxed);
+
+    size_t ring = (size_t)(maxWeight / delta) + 2, queued = 0;
+    vector<vector<int>> buckets(ring);
+    vector<long long> queuedIn(vertices, -1), settledIn(vertices, -1);
+
+    auto enqueue = [&](int v)
+    {
+        long long b = dist[v].load(memory_order_relaxed) / delta;
+        if (queuedIn[v] == b)
+            return;
+        queuedIn[v] = b;
+        buckets[b % ring].push_back(v);
+        queued++;
+    };
+
+    auto relax = [&](const vector<int>& list, bool light)
+    {
+        size_t parts = list.size() < 4096 || threads == 1 ? 1 : min<size_t>((size_t)threads * 4, list.size() / 1024);
+        vector<vector<int>> improved(parts);
+        auto body = [&](size_t part)
+        {
+            for (size_t i = list.size() * part / parts; i < list.size() * (part + 1) / parts; i++)
+            {
+                int u = list[i], du = dist[u].load(memory_order_relaxed);
+                for (arc e : g.neighbors(u))
+                {
+                    if ((e.weight <= delta) != light)
+                        continue;
+                    int candidate = du + e.weight;
+                    atomic<int>& dv = dist[e.target];
+                    int current = dv.load(memory_order_relaxed);
+                    while (candidate < current)
+                    {
+                        if (dv.compare_exchange_weak(current, candidate, memory_order_relaxed))
+                        {
+                            improved[part].push_back(e.target);
+                            break;
+                        }
+                    }
+                }
+            }
+        };
+        if (parts == 1)
+            body(0);
+        else
+            parallelFor(0, parts, threads, body);
+        for (auto& list : improved)
+            for (int v : list)
+                enqueue(v);
+    };
+
+    dist[startVer].store(0, memory_order_relaxed);
+    enqueue(startVer);
+    vector<int> frontier, settled;
+    for (long long current = 0; queued > 0; current++)
+    {
+        vector<int>& bucket = buckets[current % ring];
+        if (bucket.empty())
+            continue;
+
+        settled.clear();
+        while (!bucket.empty())
+        {
+            frontier.clear();
+            frontier.swap(bucket);
+            queued -= frontier.size();
+
+            // Устаревшие записи (вершина уже перенесена в другую корзину) отбрасываются
+            size_t live = 0;
+            for (int v : frontier)
+            {
+                if (queuedIn[v] != current)
+                    continue;
+                queuedIn[v] = -1;
+                frontier[live++] = v;
+                if (settledIn[v] != current)
+                {
+                    settledIn[v] = current;
+                    settled.push_back(v);
+                }
+            }
+            frontier.resize(live);
+            relax(frontier, true);
+        }
+        relax(settled, false);
+    }
+
+    distance.resize(vertices);
+    for (int v = 0; v < vertices; v++)
+        distance[v] = dist[v].load(memory_order_relaxed);
+}
 
-    for (int i = 0; i < adjMatrix.size(); i++) 
+// Время Δ-шагового алгоритма на 1..N потоках рядом с последовательным Дейкстрой
+template <typename Graph>
+void benchmarkDeltaStepping(const Graph& g, int vertices, int startVer, int delta, pair<int, int> weights)
+{
+    vector<int> reference, distance;
+    auto startTime = chrono::steady_clock::now();
+    dijkstra(g, reference, vertices, startVer, chooseQueue(weights.first, weights.second), weights.second);
+    double dijkstraTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "\nДейкстра: " << dijkstraTime * 1e3 << " мс\n";
+
+    double oneThread = 0;
+    for (int threads = 1; threads <= threadCount(0); threads++)
     {
-        for (int j = 0; j < adjMatrix.size(); j++) 
+        startTime = chrono::steady_clock::now();
+        deltaStepping(g, distance, vertices, startVer, delta, weights.second, threads);
+        double time = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        if (threads == 1)
+            oneThread = time;
+        cout << "Δ-шаговый, потоков " << threads << ": " << time * 1e3 << " мс, ускорение " << oneThread / time
+             << (distance == reference ? "" : ", РАССТОЯНИЯ РАЗЛИЧАЮТСЯ") << "\n";
+    }
+}
+
+// Ориентиры ALT: расстояния от нескольких вершин-ориентиров и до них. По неравенству
+// треугольника d(L, y) - d(L, x) и d(x, L) - d(y, L) — нижние оценки d(x, y)
+struct landmarkIndex
+{
+    vector<int> landmarks;
+    vector<vector<int>> from, to; // from[i][v] = d(L_i, v), to[i][v] = d(v, L_i)
+
+    long long lowerBound(int x, int y) const
+    {
+        const int INF = numeric_limits<int>::max();
+        long long bound = 0;
+        for (size_t i = 0; i < landmarks.size(); i++)
         {
-            if (i == j) distance[i][j] = 0;
-            else if (adjMatrix[i][j]) distance[i][j] = adjMatrix[i][j];
-            else distance[i][j] = INF;
+            if (from[i][x] != INF && from[i][y] != INF)
+                bound = max(bound, (long long)from[i][y] - from[i][x]);
+            if (to[i][x] != INF && to[i][y] != INF)
+                bound = max(bound, (long long)to[i][x] - to[i][y]);
         }
+        return bound;
     }
+};
 
-    for (int k = 0; k < adjMatrix.size(); k++) 
+// Ориентиры выбираются жадно: первый — вершина наибольшей степени, каждый следующий — самая
+// далёкая от уже выбранных (недостижимые из них вершины считаются самыми далёкими).
+// Деревья кратчайших путей строятся по графу g и транспонированному gr
+landmarkIndex buildLandmarks(const csrGraph& g, const csrGraph& gr, int count, pair<int, int> weights)
+{
+    landmarkIndex index;
+    int vertices = g.vertices, kind = chooseQueue(weights.first, weights.second);
+    count = min(count, vertices);
+
+    vector<int> nearest(vertices, numeric_limits<int>::max());
+    int next = 0;
+    for (int v = 1; v < vertices; v++)
+        if (g.degree(v) + gr.degree(v) > g.degree(next) + gr.degree(next))
+            next = v;
+
+    for (int i = 0; i < count; i++)
     {
-        for (int i = 0; i < adjMatrix.size(); i++)
+        index.landmarks.push_back(next);
+        index.from.emplace_back();
+        index.to.emplace_back();
+        dijkstra(g, index.from.back(), vertices, next, kind, weights.second);
+        dijkstra(gr, index.to.back(), vertices, next, kind, weights.second);
+
+        nearest[next] = 0;
+        for (int v = 0; v < vertices; v++)
         {
-            for (int j = 0; j < adjMatrix.size(); j++)
+            nearest[v] = min(nearest[v], index.from.back()[v]);
+            if (nearest[v] > nearest[next])
+                next = v;
+        }
+        if (nearest[next] == 0)
+            break;
+    }
+    return index;
+}
+
+struct pointQuery
+{
+    int distance = numeric_limits<int>::max();
+    vector<int> path;  // от s до t включительно, пустой, если t недостижима
+    size_t settled = 0; // вершин, извлечённых из очередей обоих направлений
+};
+
+// Двунаправленный Дейкстра: прямой поиск из s по g и обратный из t по gr идут поочерёдно
+// (шаг делает сторона с меньшим ключом), mu — лучший найденный путь через встречу поисков.
+// С ориентирами поиск идёт по приведённым весам с потенциалом p(v) = (d*(v, t) - d*(s, v)) / 2,
+// где d* — нижние оценки ALT; ключи хранятся удвоенными, чтобы не делить пополам.
+// Поиск останавливается, когда сумма наименьших ключей очередей не меньше 2·mu.
+// Веса должны быть неотрицательными
+pointQuery bidirectionalDijkstra(const csrGraph& g, const csrGraph& gr, int s, int t,
+    const landmarkIndex* landmarks = nullptr)
+{
+    const int INF = numeric_limits<int>::max();
+    int vertices = g.vertices;
+    pointQuery result;
+
+    auto potential = [&](int v) -> long long
+    {
+        return landmarks ? landmarks->lowerBound(v, t) - landmarks->lowerBound(s, v) : 0;
+    };
+
+    typedef priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> minQueue;
+    vector<int> distance[2] = { vector<int>(vertices, INF), vector<int>(vertices, INF) };
+    vector<int> parent[2] = { vector<int>(vertices, -1), vector<int>(vertices, -1) };
+    vector<char> settled[2] = { vector<char>(vertices, 0), vector<char>(vertices, 0) };
+    minQueue q[2];
+    const csrGraph* graphs[2] = { &g, &gr };
+
+    distance[0][s] = 0;
+    distance[1][t] = 0;
+    q[0].push({ potential(s), s });
+    q[1].push({ -potential(t), t });
+    long long mu = s == t ? 0 : numeric_limits<long long>::max();
+    int meet = s == t ? s : -1;
+
+    while (!q[0].empty() && !q[1].empty())
+    {
+        if (mu != numeric_limits<long long>::max() && q[0].top().first + q[1].top().first >= 2 * mu)
+            break;
+
+        int side = q[0].top().first <= q[1].top().first ? 0 : 1;
+        int a = q[side].top().second;
+        q[side].pop();
+        if (settled[side][a]) continue;
+        settled[side][a] = true;
+        result.settled++;
+
+        for (arc e : graphs[side]->neighbors(a))
+        {
+            int b = e.target;
+            if (distance[side][a] + e.weight < distance[side][b])
+            {
+                distance[side][b] = distance[side][a] + e.weight;
+                parent[side][b] = a;
+                long long p = potential(b);
+                q[side].push({ 2LL * distance[side][b] + (side ? -p : p), b });
+                if (distance[1 - side][b] != INF && (long long)distance[side][b] + distance[1 - side][b] < mu)
+                {
+                    mu = (long long)distance[side][b] + distance[1 - side][b];
+                    meet = b;
+                }
+            }
+        }
+    }
+
+    if (meet < 0)
+        return result;
+    result.distance = (int)mu;
+    for (int v = meet; v != -1; v = parent[0][v])
+        result.path.push_back(v);
+    reverse(result.path.begin(), result.path.end());
+    for (int v = parent[1][meet]; v != -1; v = parent[1][v])
+        result.path.push_back(v);
+    return result;
+}
+
+// Матрица расстояний для алгоритма Флойда–Уоршелла: один непрерывный массив, строки
+// дополнены до целого числа блоков, фиктивные ячейки хранят floydInf и ни на что не влияют
+const int floydTile = 64;
+const int floydInf = numeric_limits<int>::max() / 2;
+
+struct distanceMatrix
+{
+    int vertices = 0;
+    size_t stride = 0;
+    vector<int> cells;
+
+    int* row(int i) { return cells.data() + i * stride; }
+    const int* row(int i) const { return cells.data() + i * stride; }
+};
+
+// c[j] = min(c[j], a + b[j]) для count элементов строки. floydInf = INT_MAX / 2, поэтому
+// сумма двух «бесконечностей» не переполняется, а строки с недостижимой a пропускаются
+void relaxRow(int* c, const int* b, int a, int count)
+{
+    if (a >= floydInf)
+        return;
+    int j = 0;
+#ifdef __AVX2__
+    __m256i shift = _mm256_set1_epi32(a);
+    for (; j + 8 <= count; j += 8)
+    {
+        __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(b + j)), shift);
+        __m256i cur = _mm256_loadu_si256((const __m256i*)(c + j));
+        _mm256_storeu_si256((__m256i*)(c + j), _mm256_min_epi32(cur, sum));
+    }
+#endif
+    for (; j < count; j++)
+        c[j] = min(c[j], a + b[j]);
+}
+
+// Блочный Флойд–Уоршелл. На шаге kb сначала замыкается диагональный блок (kb, kb), затем
+// блоки строки и столбца kb, которые зависят только от него, и после этого все остальные
+// блоки, зависящие лишь от уже готовых блоков строки и столбца. Блоки второй и третьей
+// фаз независимы друг от друга и обрабатываются параллельно. Матрица заполняется прямо по дугам
+// CSR: из кратных дуг берётся наименьший вес, дуги веса 0 сохраняются, как и у Дейкстры
+void floydWarshall(const csrGraph& g, distanceMatrix& distance, int threads)
+{
+    int vertices = g.vertices;
+    int blocks = (vertices + floydTile - 1) / floydTile;
+    distance.vertices = vertices;
+    distance.stride = (size_t)blocks * floydTile;
+    distance.cells.assign(distance.stride * distance.stride, floydInf);
+
+    for (int i = 0; i < vertices; i++)
+    {
+        int* d = distance.row(i);
+        d[i] = 0;
+        for (arc e : g.neighbors(i))
+            d[e.target] = min(d[e.target], e.weight);
+    }
+
+    // Блок (ib, jb) через промежуточные вершины блока kb. Порядок k-i-j нужен, когда
+    // обновляемый блок совпадает с блоком строки или столбца kb; иначе берём i-k-j
+    auto relaxTile = [&](int ib, int jb, int kb, bool inPlace)
+    {
+        int iEnd = (ib + 1) * floydTile, kEnd = (kb + 1) * floydTile, j0 = jb * floydTile;
+        if (inPlace)
+        {
+            for (int k = kb * floydTile; k < kEnd; k++)
+                for (int i = ib * floydTile; i < iEnd; i++)
+                    relaxRow(distance.row(i) + j0, distance.row(k) + j0, distance.row(i)[k], floydTile);
+        }
+        else
+        {
+            for (int i = ib * floydTile; i < iEnd; i++)
+                for (int k = kb * floydTile; k < kEnd; k++)
+                    relaxRow(distance.row(i) + j0, distance.row(k) + j0, distance.row(i)[k], floydTile);
+        }
+    };
+
+    threads = blocks > 1 ? threadCount(threads) : 1;
+    for (int kb = 0; kb < blocks; kb++)
+    {
+        relaxTile(kb, kb, kb, true);
+
+        parallelFor(0, 2 * (size_t)blocks, threads, [&](size_t t)
+        {
+            int other = (int)(t / 2);
+            if (other == kb)
+                return;
+            if (t % 2)
+                relaxTile(other, kb, kb, true);
+            else
+                relaxTile(kb, other, kb, true);
+        });
+
+        parallelFor(0, (size_t)blocks * blocks, threads, [&](size_t t)
+        {
+            int ib = (int)(t / blocks), jb = (int)(t % blocks);
+            if (ib != kb && jb != kb)
+                relaxTile(ib, jb, kb, false);
+        });
+    }
+
+    // При отрицательных весах к «бесконечности» могут прибавиться отрицательные слагаемые,
+    // поэтому всё, что осталось выше половины floydInf, считаем недостижимым
+    for (int& cell : distance.cells)
+        if (cell > floydInf / 2)
+            cell = numeric_limits<int>::max();
+}
+
+// Потенциалы Джонсона — расстояния от фиктивной вершины, из которой во все вершины ведут
+// дуги веса 0, по алгоритму Беллмана–Форда с очередью (SPFA). length[v] — число дуг графа
+// в текущем пути до v; если оно дошло до vertices, путь содержит цикл отрицательного веса
+bool johnsonPotentials(const csrGraph& g, vector<int>& potential)
+{
+    int vertices = g.vertices;
+    potential.assign(vertices, 0);
+    vector<int> length(vertices, 0);
+    vector<bool> queued(vertices, true);
+    queue<int> q;
+    for (int v = 0; v < vertices; v++)
+        q.push(v);
+
+    while (!q.empty())
+    {
+        int a = q.front();
+        q.pop();
+        queued[a] = false;
+        for (arc e : g.neighbors(a))
+        {
+            int b = e.target;
+            if (potential[a] + e.weight < potential[b])
             {
-                distance[i][j] = min(distance[i][j], distance[i][k] + distance[k][j]);
+                potential[b] = potential[a] + e.weight;
+                length[b] = length[a] + 1;
+                if (length[b] >= vertices)
+                    return false;
+                if (!queued[b])
+                {
+                    queued[b] = true;
+                    q.push(b);
+                }
             }
         }
     }
+    return true;
+}
+
+// Веса w(u, v) + h(u) - h(v) неотрицательны и сохраняют кратчайшие пути. При нулевых
+// потенциалах (отрицательных весов нет) граф используется как есть
+csrGraph reweightGraph(const csrGraph& g, const vector<int>& potential, int threads)
+{
+    if (!g.weighted || all_of(potential.begin(), potential.end(), [](int h) { return h == 0; }))
+        return g;
+
+    auto buffers = make_shared<csrBuffers>();
+    csrBuffers& t = *buffers;
+    t.offsets.assign(g.offsets, g.offsets + g.vertices + 1);
+    t.targets.assign(g.targets, g.targets + g.arcs());
+    t.weights.resize(g.arcs());
+    parallelFor(0, g.vertices, threadCount(threads), [&](size_t u)
+    {
+        for (uint32_t i = g.begin((int)u); i < g.end((int)u); i++)
+            t.weights[i] = g.weights[i] + potential[u] - potential[g.targets[i]];
+    });
+    return makeCsr(g.vertices, g.weighted, buffers);
+}
+
+// Кратчайшие пути между всеми парами по Джонсону: перевзвешивание и по алгоритму Дейкстры из
+// каждой вершины. Источники идут блоками по несколько на поток: блок считается параллельно,
+// затем его строки по порядку передаются в row, так что матрица V×V целиком не хранится.
+// Граф может быть перенумерован: источники и столбцы строк — в исходных номерах вершин.
+// Возвращает false, если в графе есть цикл отрицательного веса
+bool johnsonAllPairs(const csrGraph& g, int threads, const vertexPermutation& permutation,
+    const function<void(int, const vector<int>&)>& row)
+{
+    int vertices = g.vertices;
+    vector<int> potential;
+    if (!johnsonPotentials(g, potential))
+        return false;
+
+    csrGraph reweighted = reweightGraph(g, potential, threads);
+    pair<int, int> weights = weightRange(reweighted);
+    int kind = chooseQueue(weights.first, weights.second);
+
+    threads = threadCount(threads);
+    int block = min(vertices, threads * 4);
+    vector<vector<int>> distance(block), rows(block, vector<int>(vertices));
+    for (int first = 0; first < vertices; first += block)
+    {
+        int count = min(block, vertices - first);
+        parallelFor(0, count, threads, [&](size_t i)
+        {
+            int s = permutation.renamed(first + (int)i);
+            dijkstra(reweighted, distance[i], vertices, s, kind, weights.second);
+            for (int v = 0; v < vertices; v++)
+            {
+                int d = distance[i][permutation.renamed(v)];
+                rows[i][v] = d == numeric_limits<int>::max() ? d : d - potential[s] + potential[permutation.renamed(v)];
+            }
+        });
+        for (int i = 0; i < count; i++)
+            row(first + i, rows[i]);
+    }
+    return true;
+}
+
+void printDistanceRow(const int* row, int vertices)
+{
+    for (int j = 0; j < vertices; j++) 
+    {
+        if (row[j] == numeric_limits<int>::max())
+            cout << "INF ";
+        else
+            cout << row[j] << " ";
+    }
+    cout << "\n";
 }
 
 int main() 
 {
     setlocale(LC_ALL, "Russian");
 
-    string list = "list.txt", matrix = "matrix.txt";
-    vector<vector<pair<int, int>>> adjList;
-    vector<vector<int>> adjMatrix;
-    int startVer, toVer, vertices;
+    string inputfilePath = "input.txt", binaryFilePath = "graph.bin", listFilePath = "list.txt", matrixFilePath = "matrix.txt";
+    vector<Edge> edgeList;
+    graphParameters graph;
+    int startVer, toVer, vertices, answer, source, order, kind, algorithm, delta = 0;
+    csrGraph g;
+    future<void> saving;
+
+    // Граф генерируется по input.txt, открывается из двоичного файла без разбора и копирования
+    // или читается из сохранённого ранее списка или матрицы смежности
+    cout << "Источник графа (0 - генерация по input.txt, 1 - файл graph.bin, 2 - файл list.txt, 3 - файл matrix.txt): ";
+    cin >> source;
+
+    if (source == 2 || source == 3)
+    {
+        g = source == 2 ? readAdjacencyList(listFilePath) : readAdjacencyMatrix(matrixFilePath);
+        vertices = g.vertices;
+        cout << "Количество вершин: " << vertices << "\tКоличество дуг: " << g.arcs();
+    }
+    else if (source)
+    {
+        g = openBinaryGraph(binaryFilePath, graph.directed);
+        vertices = g.vertices;
+        cout << "Количество вершин: " << vertices << "\tКоличество дуг: " << g.arcs();
+    }
+    else
+    {
+        readData(inputfilePath, graph);
+        generateGraph(graph, edgeList, vertices);
 
-    generateGraph(vertices);
+        // Алгоритмы работают с графом в памяти, запись в файлы идёт в фоне и не задерживает их
+        cout << "\nСохранить граф в list.txt, matrix.txt и graph.bin? (0 - нет, 1 - да): ";
+        cin >> answer;
+        if (answer)
+            saving = saveGraphAsync(edgeList, vertices, graph);
 
-    readAdjacencyList(adjList, vertices, list);
-    readAdjacencyMatrix(adjMatrix, vertices, matrix);
+        g = buildCsr(edgeList, vertices, graph.directed, graph.weighted, graph.threads);
+    }
 
     vector<int> distance(vertices);
-    vector<vector<int>> distance1(vertices, vector<int>(vertices, 0));
 
     cout << "\nВведите стартовую вершину для поиска кратчайших путей в алгоритме Дейкстры: ";
     cin >> startVer;
@@ -156,54 +932,255 @@ int main()
     if (startVer < 0 || startVer >= vertices) 
     {
         cerr << "Ошибка: неверная стартовая вершина.\n";
+        if (saving.valid()) saving.wait();
         return 1;
     }
 
-    dijkstra(adjList, distance, vertices, startVer);
+    // Перенумерация вершин делает обращения к соседям более локальными; расстояния
+    // выводятся в исходных номерах вершин
+    vertexPermutation permutation;
+    cout << "Порядок вершин (0 - исходный, 1 - по убыванию степени, 2 - RCM, 3 - BFS, 4 - сравнить все): ";
+    cin >> order;
+    if (order == 4)
+    {
+        benchmarkOrders(g, graph.threads, [&](const csrGraph& pg, const vertexPermutation& p)
+        {
+            dijkstra(pg, distance, vertices, p.renamed(startVer));
+        });
+    }
+    else if (order != originalOrder)
+    {
+        permutation = computeOrder(g, order);
+        g = permuteGraph(g, permutation, graph.threads);
+    }
+
+    // Диапазон весов известен из input.txt, для графа из файла он находится просмотром дуг
+    pair<int, int> weights = source ? weightRange(g) : graph.weighted ? make_pair(graph.Wmin, graph.Wmax) : make_pair(1, 1);
 
-    cout << "\nРасстояния от вершины " << startVer << " до:\n";
-    for (int i = 0; i < vertices; i++) {
-        if (distance[i] == numeric_limits<int>::max()) 
+    // Путь между двумя вершинами ищется двунаправленным Дейкстрой без поиска от s до всех вершин;
+    // ориентиры ALT дополнительно направляют его к цели. Отрицательные веса сначала убираются
+    // перевзвешиванием Джонсона: длины всех путей s–t меняются на одно и то же h(s) - h(t)
+    int mode;
+    cout << "Режим (0 - расстояния от стартовой вершины до всех, 1 - путь между двумя вершинами): ";
+    cin >> mode;
+    if (mode == 1)
+    {
+        cout << "Конечная вершина: ";
+        cin >> toVer;
+        if (toVer < 0 || toVer >= vertices) 
         {
-            cout << "Вершина " << i << ": недостижима\n";
+            cerr << "Ошибка: неверная конечная вершина.\n";
+            if (saving.valid()) saving.wait();
+            return 1;
         }
-        else 
+        int count;
+        cout << "Число ориентиров ALT (0 - без ориентиров): ";
+        cin >> count;
+
+        auto preparationStart = chrono::steady_clock::now();
+        csrGraph reweighted = g;
+        vector<int> potential;
+        pair<int, int> reweightedRange = weights;
+        if (weights.first < 0)
         {
-            cout << "Вершины " << i << ": " << distance[i] << "\n";
+            if (!johnsonPotentials(g, potential))
+            {
+                cout << "В графе есть цикл отрицательного веса, кратчайшие пути не определены.\n";
+                if (saving.valid()) saving.wait();
+                return 0;
+            }
+            reweighted = reweightGraph(g, potential, graph.threads);
+            reweightedRange = weightRange(reweighted);
         }
-    }
+        csrGraph gr = reweighted.transposed();
+        landmarkIndex landmarks;
+        if (count > 0)
+            landmarks = buildLandmarks(reweighted, gr, count, reweightedRange);
+        double preparationTime = chrono::duration<double>(chrono::steady_clock::now() - preparationStart).count();
 
-    cout << "\nРасстояние до какой вершины вы хотите узнать? ";
-    cin >> toVer;
+        int s = permutation.renamed(startVer), t = permutation.renamed(toVer);
+        auto queryStart = chrono::steady_clock::now();
+        pointQuery query = bidirectionalDijkstra(reweighted, gr, s, t, count > 0 ? &landmarks : nullptr);
+        double queryTime = chrono::duration<double>(chrono::steady_clock::now() - queryStart).count();
+        if (!potential.empty() && query.distance != numeric_limits<int>::max())
+            query.distance += potential[t] - potential[s];
 
-    if (toVer < 0 || toVer >= vertices) 
-    {
-        cerr << "Ошибка: неверная конечная вершина.\n";
-        return 1;
+        cout << "Подготовка " << preparationTime * 1e3 << " мс (ориентиров: " << landmarks.landmarks.size()
+             << "), запрос " << queryTime * 1e3 << " мс, просмотрено вершин " << query.settled << " из " << vertices << "\n";
+        if (query.distance == numeric_limits<int>::max())
+        {
+            cout << "Вершина " << toVer << " недостижима из вершины " << startVer << ".\n";
+        }
+        else
+        {
+            cout << "Расстояние от вершины " << startVer << " до вершины " << toVer << " равно " << query.distance << ".\n";
+            cout << "Путь:";
+            for (int v : query.path)
+                cout << " " << permutation.original(v);
+            cout << "\n";
+        }
     }
-
-    if (distance[toVer] == numeric_limits<int>::max()) 
+    else
     {
-        cout << "Вершина " << toVer << " недостижима из вершины " << startVer << ".\n";
+        // Отрицательные веса убираются перевзвешиванием Джонсона: расстояние из s до v на новом
+        // графе равно исходному плюс h(s) - h(v), поэтому его можно пересчитать обратно. Граф g
+        // не меняется — он ещё нужен для путей между всеми парами
+        csrGraph sg = g;
+        vector<int> potential;
+        if (weights.first < 0)
+        {
+            cout << "В графе есть отрицательные веса, граф перевзвешивается по алгоритму Джонсона.\n";
+            if (!johnsonPotentials(g, potential))
+            {
+                cout << "В графе есть цикл отрицательного веса, кратчайшие пути не определены.\n";
+                if (saving.valid()) saving.wait();
+                return 0;
+            }
+            sg = reweightGraph(g, potential, graph.threads);
+            weights = weightRange(sg);
+        }
+
+        cout << "Очередь с приоритетом (0 - выбрать по диапазону весов, 1 - двоичная куча, 2 - 4-арная куча, "
+             << "3 - поразрядная куча, 4 - корзины Дайала, 5 - сравнить все): ";
+        cin >> kind;
+        if (kind == 5)
+            benchmarkQueues(sg, vertices, permutation.renamed(startVer), weights);
+        if (kind == 0 || kind == 5)
+        {
+            kind = chooseQueue(weights.first, weights.second);
+            cout << "Веса " << (potential.empty() ? "" : "после перевзвешивания ") << "от " << weights.first << " до "
+                 << weights.second << ", выбрана очередь: " << (kind == dialQueue ? "корзины Дайала" : "поразрядная куча") << "\n";
+        }
+        else
+        {
+            kind--;
+        }
+
+        cout << "Алгоритм (0 - Дейкстра, 1 - параллельный Δ-шаговый, 2 - Δ-шаговый на 1..N потоках): ";
+        cin >> algorithm;
+        if (algorithm)
+        {
+            cout << "Ширина корзины Δ (0 - по диапазону весов): ";
+            cin >> delta;
+            if (delta <= 0)
+                delta = defaultDelta(weights.first, weights.second, vertices, sg.arcs());
+            cout << "Δ = " << delta << "\n";
+        }
+
+        // Оба алгоритма одинаково работают с CSR и со сжатыми списками смежности
+        vector<int> renamedDistance;
+        auto shortestPaths = [&](const auto& pg)
+        {
+            if (algorithm == 2)
+                benchmarkDeltaStepping(pg, vertices, permutation.renamed(startVer), delta, weights);
+            if (algorithm)
+                deltaStepping(pg, renamedDistance, vertices, permutation.renamed(startVer), delta, weights.second, graph.threads);
+            else
+                dijkstra(pg, renamedDistance, vertices, permutation.renamed(startVer), kind, weights.second);
+        };
+        cout << "Использовать сжатые списки смежности? (0 - нет, 1 - да): ";
+        cin >> answer;
+        if (answer)
+            shortestPaths(compressGraph(sg, graph.threads));
+        else
+            shortestPaths(sg);
+
+        int s = permutation.renamed(startVer);
+        for (int i = 0; i < vertices; i++)
+        {
+            int v = permutation.renamed(i);
+            distance[i] = renamedDistance[v];
+            if (!potential.empty() && distance[i] != numeric_limits<int>::max())
+                distance[i] += potential[v] - potential[s];
+        }
+
+        cout << "\nРасстояния от вершины " << startVer << " до:\n";
+        for (int i = 0; i < vertices; i++) {
+            if (distance[i] == numeric_limits<int>::max()) 
+            {
+                cout << "Вершина " << i << ": недостижима\n";
+            }
+            else 
+            {
+                cout << "Вершины " << i << ": " << distance[i] << "\n";
+            }
+        }
+
+        cout << "\nРасстояние до какой вершины вы хотите узнать? ";
+        cin >> toVer;
+
+        if (toVer < 0 || toVer >= vertices) 
+        {
+            cerr << "Ошибка: неверная конечная вершина.\n";
+            if (saving.valid()) saving.wait();
+            return 1;
+        }
+
+        if (distance[toVer] == numeric_limits<int>::max()) 
+        {
+            cout << "Вершина " << toVer << " недостижима из вершины " << startVer << ".\n";
+        }
+        else 
+        {
+            cout << "Расстояние от вершины " << startVer << " до вершины " << toVer << " равно " << distance[toVer] << ".\n";
+        }
     }
-    else 
+
+    // Флойд–Уоршелл работает с матрицей V×V за V³, Джонсон — по спискам дуг за O(V·E log V)
+    // на всех ядрах; оба допускают отрицательные веса
+    cout << "\nКратчайшие пути между всеми парами (0 - Флойд–Уоршелл, 1 - Джонсон, 2 - сравнить): ";
+    cin >> algorithm;
+
+    distanceMatrix distance1;
+    if (algorithm != 1)
     {
-        cout << "Расстояние от вершины " << startVer << " до вершины " << toVer << " равно " << distance[toVer] << ".\n";
+        auto floydStart = chrono::steady_clock::now();
+        floydWarshall(g, distance1, graph.threads);
+        double floydTime = chrono::duration<double>(chrono::steady_clock::now() - floydStart).count();
+        if (algorithm == 0)
+            cout << "\nРезультат работы алгоритма Флойда–Уоршелла (" << floydTime * 1e3 << " мс): \n";
+        else
+            cout << "\nАлгоритм Флойда–Уоршелла: " << floydTime * 1e3 << " мс\n";
+        vector<int> row(vertices);
+        for (int i = 0; algorithm == 0 && i < vertices; i++) 
+        {
+            for (int j = 0; j < vertices; j++)
+                row[j] = distance1.row(permutation.renamed(i))[permutation.renamed(j)];
+            printDistanceRow(row.data(), vertices);
+        }
     }
-
-    floydWarshall(adjMatrix, distance1, vertices);
-    cout << "\nРезультат работы алгоритма Флойда–Уоршелла: \n";
-    for (int i = 0; i < adjMatrix.size(); i++) 
+    if (algorithm != 0)
     {
-        for (int j = 0; j < adjMatrix.size(); j++) 
+        size_t mismatches = 0;
+        auto johnsonStart = chrono::steady_clock::now();
+        if (algorithm == 1)
+            cout << "\nРезультат работы алгоритма Джонсона: \n";
+        bool correct = johnsonAllPairs(g, graph.threads, permutation, [&](int s, const vector<int>& row)
         {
-            if (distance1[i][j] == numeric_limits<int>::max())
-                cout << "INF ";
+            if (algorithm == 1)
+                printDistanceRow(row.data(), vertices);
             else
-                cout << distance1[i][j] << " ";
-        }
-        cout << "\n";
+                for (int v = 0; v < vertices; v++)
+                    mismatches += row[v] != distance1.row(permutation.renamed(s))[permutation.renamed(v)];
+        });
+        double johnsonTime = chrono::duration<double>(chrono::steady_clock::now() - johnsonStart).count();
+
+        // Цикл отрицательного веса Флойд–Уоршелл оставляет отрицательным числом на диагонали
+        bool floydCycle = false;
+        for (int v = 0; algorithm == 2 && v < vertices; v++)
+            floydCycle = floydCycle || distance1.row(v)[v] < 0;
+        if (algorithm == 2 && floydCycle == correct)
+            cout << "Ошибка: алгоритмы расходятся в наличии цикла отрицательного веса.\n";
+        if (!correct)
+            cout << "В графе есть цикл отрицательного веса, кратчайшие пути не определены.\n";
+        else if (algorithm == 2)
+            cout << "Алгоритм Джонсона: " << johnsonTime * 1e3 << " мс, расхождений с Флойдом–Уоршеллом: " << mismatches << "\n";
+        else
+            cout << "Время работы: " << johnsonTime * 1e3 << " мс\n";
     }
 
+    if (saving.valid())
+        saving.wait();
+
     return 0;
 }
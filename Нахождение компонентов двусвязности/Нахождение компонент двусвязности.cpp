@@ -1,201 +1,32 @@
-﻿#include <iostream>
-#include <fstream>
-#include <vector>
-#include <set>
-#include <stack>
-#include <algorithm>
-#include <ctime>
-#include <string>
+﻿#include <stack>
+#include "../Кратчайшие пути/initGraph.h"
 
 using namespace std;
 
-struct Edge
-{
-    int from;
-    int to;
-    int weight;
-};
-
-struct graphParameters
-{
-    int directed, weighted, self_loops;
-    int Vmin, Vmax, Emin, Emax;
-    int Wmin = 0, Wmax = 0;
-};
-
 // Переменные для поиска компонент двусвязности
 vector<int> tin, low;
 vector<bool> visited;
 stack<Edge> st;
 int timer;
 
-void readData(const string& path, graphParameters& graph)
-{
-    ifstream inputFile(path);
-
-    if (!inputFile)
-    {
-        cerr << "Ошибка при открытии файла! \n";
-        exit(1);
-    }
-
-    if (!(inputFile >> graph.directed >> graph.weighted >> graph.self_loops))
-    {
-        cerr << "Ошибка: неверный формат данных графа.\n";
-        exit(1);
-    }
-
-    if (!(inputFile >> graph.Vmin >> graph.Vmax >> graph.Emin >> graph.Emax))
-    {
-        cerr << "Ошибка: неверные параметры вершин или рёбер.\n";
-        exit(1);
-    }
-
-    if (graph.weighted)
-    {
-        if (!(inputFile >> graph.Wmin >> graph.Wmax))
-        {
-            cerr << "Ошибка: неверные параметры весов рёбер.\n";
-            exit(1);
-        }
-    }
-
-    inputFile.close();
-}
-
-void savedAdjacencyList(const vector<Edge>& edgeList, int vertices, int directed, int weighted, const string& path)
-{
-    ofstream outFile(path);
-    if (!outFile)
-    {
-        cerr << "Ошибка при открытии файла! \n";
-        exit(1);
-    }
-
-    vector<vector<pair<int, int>>> adjList(vertices);
-
-    for (const auto& edge : edgeList)
-    {
-        adjList[edge.from].push_back({ edge.to, edge.weight });
-
-        if (!directed && edge.from != edge.to)
-        {
-            adjList[edge.to].push_back({ edge.from, edge.weight });
-        }
-    }
-
-    for (int i = 0; i < vertices; ++i)
-    {
-        outFile << i << ": ";
-        for (const auto& neighbor : adjList[i])
-        {
-            if (weighted)
-            {
-                outFile << "(" << neighbor.first << ", " << neighbor.second << ") ";
-            }
-            else
-            {
-                outFile << neighbor.first << " ";
-            }
-        }
-        outFile << "\n\n";
-    }
-
-    outFile.close();
-}
-
-void generateGraph(graphParameters& graph, vector<Edge>& edgeList, int& ver)
-{
-    srand(static_cast<unsigned int>(time(0)));
-
-    int vertices = graph.Vmin + rand() % (graph.Vmax - graph.Vmin + 1);
-    ver = vertices;
-    int edges = graph.Emin + rand() % (graph.Emax - graph.Emin + 1);
+// Перенумерация вершин; точки сочленения и рёбра выводятся в исходных номерах
+vertexPermutation permutation;
 
-    cout << "Количество вершин: " << vertices << "\tКоличество рёбер: " << edges << endl;
-
-    set<pair<int, int>> edgeSet;
-
-    for (int i = 0; i < edges; i++)
-    {
-        int from = rand() % vertices;
-        int to = rand() % vertices;
-
-        if (!graph.self_loops && from == to)
-        {
-            i--;
-            continue;
-        }
-
-        if (!graph.directed && from > to)
-        {
-            swap(from, to);
-        }
-
-        if (edgeSet.count({ from, to }))
-        {
-            i--;
-            continue;
-        }
-
-        edgeSet.insert({ from, to });
-
-        int weight = 0;
-        if (graph.weighted)
-        {
-            weight = graph.Wmin + rand() % (graph.Wmax - graph.Wmin + 1);
-        }
-
-        edgeList.push_back({ from, to, weight });
-    }
-}
-
-
-void readAdjacencyList(const string& path, vector<vector<int>>& adjList)
+void printEdge(const Edge& e)
 {
-    ifstream inputFile(path);
-    if (!inputFile) {
-        cerr << "Ошибка при открытии файла для чтения списка смежности! \n";
-        exit(1);
-    }
-
-    adjList.clear();
-    string line;
-    while (getline(inputFile, line)) {
-        if (line.empty()) continue;
-
-        size_t pos = line.find(":");
-        if (pos == string::npos) continue;
-
-        int vertex = stoi(line.substr(0, pos));
-        adjList.resize(max((int)adjList.size(), vertex + 1));
-
-        string neighbors = line.substr(pos + 1);
-        size_t start = 0, end;
-        while ((end = neighbors.find(" ", start)) != string::npos)
-        {
-            string neighborStr = neighbors.substr(start, end - start);
-            if (!neighborStr.empty())
-            {
-                int neighbor = stoi(neighborStr);
-                adjList[vertex].push_back(neighbor);
-            }
-            start = end + 1;
-        }
-    }
-
-    inputFile.close();
+    cout << "(" << permutation.original(e.from) << ", " << permutation.original(e.to) << ") ";
 }
 
 // Алгоритм поиска компонент двусвязности
-void dfs(int v, int parent, vector<vector<int>>& adjList)
+void dfs(int v, int parent, const csrGraph& g)
 {
     visited[v] = true;
     tin[v] = low[v] = timer++;
     int children = 0;
 
-    for (int to : adjList[v])
+    for (uint32_t i = g.begin(v); i < g.end(v); i++)
     {
+        int to = g.targets[i];
         if (to == parent) continue;
 
         if (visited[to])
@@ -203,24 +34,24 @@ void dfs(int v, int parent, vector<vector<int>>& adjList)
             low[v] = min(low[v], tin[to]);
             if (tin[to] < tin[v])
             {
-                st.push({ v, to });
+                st.push({ v, to, 0 });
             }
         }
         else
         {
-            st.push({ v, to });
-            dfs(to, v, adjList);
+            st.push({ v, to, 0 });
+            dfs(to, v, g);
             low[v] = min(low[v], low[to]);
 
             if (low[to] >= tin[v] && parent != -1)
             {
-                cout << "Точка сочленения: " << v << endl;
+                cout << "Точка сочленения: " << permutation.original(v) << endl;
 
                 while (!st.empty())
                 {
                     Edge e = st.top();
                     st.pop();
-                    cout << "(" << e.from << ", " << e.to << ") ";
+                    printEdge(e);
                     if (e.from == v && e.to == to) break;
                 }
                 cout << endl;
@@ -232,18 +63,18 @@ void dfs(int v, int parent, vector<vector<int>>& adjList)
 
     if (parent == -1 && children > 1)
     {
-        cout << "Точка сочленения: " << v << endl;
+        cout << "Точка сочленения: " << permutation.original(v) << endl;
         while (!st.empty())
         {
             Edge e = st.top();
             st.pop();
-            cout << "(" << e.from << ", " << e.to << ") ";
+            printEdge(e);
         }
         cout << endl;
     }
 }
 
-void findBiconnectedComponents(int n, vector<vector<int>>& adjList)
+void findBiconnectedComponents(int n, const csrGraph& g)
 {
     tin.assign(n, -1);
     low.assign(n, -1);
@@ -254,7 +85,7 @@ void findBiconnectedComponents(int n, vector<vector<int>>& adjList)
     {
         if (!visited[i])
         {
-            dfs(i, -1, adjList);
+            dfs(i, -1, g);
         }
     }
 
@@ -264,7 +95,7 @@ void findBiconnectedComponents(int n, vector<vector<int>>& adjList)
         {
             Edge e = st.top();
             st.pop();
-            cout << "(" << e.from << ", " << e.to << ") ";
+            printEdge(e);
         }
         cout << endl;
     }
@@ -279,20 +110,59 @@ int main()
     int vertices;
 
     vector<Edge> edgeList;
-    vector<vector<int>> adjList;
 
-    readData(inputfilePath, graph);
+    int answer, source, order;
+    csrGraph g;
+    future<void> saving;
 
-    generateGraph(graph, edgeList, vertices);
+    // Граф генерируется по input.txt или читается из сохранённого ранее списка смежности
+    cout << "Источник графа (0 - генерация по input.txt, 1 - файл " << outputFilePath << "): ";
+    cin >> source;
 
-    savedAdjacencyList(edgeList, vertices, graph.directed, graph.weighted, outputFilePath);
+    if (source)
+    {
+        g = readAdjacencyList(outputFilePath);
+        vertices = g.vertices;
+    }
+    else
+    {
+        readData(inputfilePath, graph);
 
-    // Читаем сгенерированный граф
-    readAdjacencyList(outputFilePath, adjList);
+        generateGraph(graph, edgeList, vertices);
+        cout << endl;
+
+        // Запись в файл необязательна и идёт в фоне, пока ищутся компоненты
+        cout << "Сохранить граф в " << outputFilePath << "? (0 - нет, 1 - да): ";
+        cin >> answer;
+        if (answer)
+            saving = async(launch::async, [&]() { savedAdjacencyList(edgeList, vertices, graph.directed, graph.weighted, outputFilePath, graph.threads); });
+
+        // Граф берётся прямо из памяти
+        g = buildCsr(edgeList, vertices, graph.directed, 0, graph.threads);
+    }
+
+    // Перенумерация вершин делает обращения к соседям более локальными
+    cout << "\nПорядок вершин (0 - исходный, 1 - по убыванию степени, 2 - RCM, 3 - BFS, 4 - сравнить все): ";
+    cin >> order;
+    if (order == 4)
+    {
+        benchmarkOrders(g, graph.threads, [&](const csrGraph& pg, const vertexPermutation&)
+        {
+            findBiconnectedComponents(vertices, pg);
+        });
+    }
+    else if (order != originalOrder)
+    {
+        permutation = computeOrder(g, order);
+        g = permuteGraph(g, permutation, graph.threads);
+    }
 
     // Находим компоненты двусвязности
     cout << "\nКомпоненты двусвязности:\n";
-    findBiconnectedComponents(vertices, adjList);
+    findBiconnectedComponents(vertices, g);
+
+    if (saving.valid())
+        saving.wait();
 
     return 0;
 }
\ No newline at end of file
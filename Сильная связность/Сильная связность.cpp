@@ -1,265 +1,1330 @@
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <ctime>
-#include <set>
-#include <stack>
+﻿#include <atomic>
+#include <chrono>
+#include <random>
+#include "../Кратчайшие пути/initGraph.h"
 using namespace std;
 
-struct Edge {
-    int from;
-    int to;
-    int weight;
-};
+// Перенумерация вершин; компоненты выводятся в исходных номерах
+vertexPermutation permutation;
 
-struct graphParameters {
-    int directed, weighted, self_loops;
-    int Vmin, Vmax, Emin, Emax;
-    int Wmin = 0, Wmax = 0;
-};
+// Итеративный алгоритм Пирса (вариант Тарьяна без отдельных index и lowlink): один обход
+// только прямого графа, явный стек вместо рекурсии. rindex[v] == 0 — вершина не посещена;
+// пока вершина на стеке, rindex — её номер посещения или меньший номер достижимой из неё
+// вершины; после выделения компоненты — номер компоненты c, отсчитываемый от V - 1 вниз.
+// Возвращает номер компоненты каждой вершины; компоненты нумеруются в порядке завершения,
+// то есть из компоненты с меньшим номером нет дуг в компоненты с большим
+template <typename Graph>
+vector<int> strongComponents(const Graph& g)
+{
+    using arcIterator = decltype(g.neighbors(0).begin());
+    struct frame
+    {
+        int v;
+        bool root;
+        arcIterator it, end;
+    };
+
+    int vertices = g.vertices;
+    vector<int> rindex(vertices, 0), component(vertices);
+    vector<int> st;
+    vector<frame> calls;
+    int index = 1, c = vertices - 1;
+
+    auto visit = [&](int v)
+    {
+        rindex[v] = index++;
+        auto range = g.neighbors(v);
+        calls.push_back({ v, true, range.begin(), range.end() });
+    };
+
+    for (int s = 0; s < vertices; s++)
+    {
+        if (rindex[s] != 0)
+            continue;
+
+        visit(s);
+        while (!calls.empty())
+        {
+            frame& f = calls.back();
+            if (f.it != f.end)
+            {
+                int w = (*f.it).target;
+                if (rindex[w] == 0)
+                {
+                    visit(w); // f больше не используется: calls мог перераспределиться
+                    continue;
+                }
+                if (rindex[w] < rindex[f.v])
+                {
+                    rindex[f.v] = rindex[w];
+                    f.root = false;
+                }
+                ++f.it;
+                continue;
+            }
+
+            // Все соседи v просмотрены
+            int v = f.v;
+            if (f.root)
+            {
+                index--;
+                while (!st.empty() && rindex[v] <= rindex[st.back()])
+                {
+                    rindex[st.back()] = c;
+                    st.pop_back();
+                    index--;
+                }
+                rindex[v] = c--;
+            }
+            else
+            {
+                st.push_back(v);
+            }
+            calls.pop_back();
+
+            // Возврат в родителя: его rindex уменьшается до rindex ребёнка
+            if (!calls.empty())
+            {
+                frame& parent = calls.back();
+                if (rindex[v] < rindex[parent.v])
+                {
+                    rindex[parent.v] = rindex[v];
+                    parent.root = false;
+                }
+                ++parent.it;
+            }
+        }
+    }
+
+    for (int v = 0; v < vertices; v++)
+        component[v] = vertices - 1 - rindex[v];
+    return component;
+}
 
-void savedAdjacencyList(vector<Edge> edgeList, int vertices, int directed, int weighted, string path)
+// Номера компонент по возрастанию наименьшей вершины компоненты — одинаковое разбиение
+// даёт одинаковые номера при любом алгоритме и числе потоков
+vector<int> canonicalComponents(const vector<int>& componentOf)
 {
-    ofstream outFile(path);
-    if (!outFile)
+    int count = componentOf.empty() ? 0 : *max_element(componentOf.begin(), componentOf.end()) + 1;
+    vector<int> renamed(count, -1), canonical(componentOf.size());
+    int next = 0;
+    for (size_t v = 0; v < componentOf.size(); v++)
     {
-        cerr << "Ошибка при открытии файла! \n";
-        exit(1);
+        int& id = renamed[componentOf[v]];
+        if (id < 0)
+            id = next++;
+        canonical[v] = id;
     }
+    return canonical;
+}
 
-    vector<vector<pair<int, int>>> adjList(vertices);
+// Атомарный максимум: color[v] = max(color[v], value); true, если значение выросло
+bool atomicMax(atomic<int>& target, int value)
+{
+    int current = target.load(memory_order_relaxed);
+    while (current < value)
+    {
+        if (target.compare_exchange_weak(current, value, memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
 
-    for (size_t i = 0; i < edgeList.size(); i++)
+// Обрабатывает list участками в threads потоках; body(i, next) может добавлять вершины в next,
+// списки участков склеиваются в порядке участков
+vector<int> parallelExpand(const vector<int>& list, int threads, const function<void(int, vector<int>&)>& body)
+{
+    size_t parts = min<size_t>((size_t)threads * 4, (list.size() + 1023) / 1024);
+    if (parts <= 1)
     {
-        const Edge& edge = edgeList[i]; // Получаем текущее ребро по индексу 
+        vector<int> next;
+        for (int v : list)
+            body(v, next);
+        return next;
+    }
 
-        adjList[edge.from].push_back({ edge.to, edge.weight });
+    vector<vector<int>> partNext(parts);
+    parallelFor(0, parts, threads, [&](size_t part)
+    {
+        size_t first = list.size() * part / parts, last = list.size() * (part + 1) / parts;
+        for (size_t i = first; i < last; i++)
+            body(list[i], partNext[part]);
+    });
 
-        // Если граф неориентированный, добавляем обратное ребро
-        if (!directed && edge.from != edge.to)
+    vector<int> next;
+    for (auto& part : partNext)
+        next.insert(next.end(), part.begin(), part.end());
+    return next;
+}
+
+// Параллельное выделение сильно связных компонент (g — граф, gr — обратный граф):
+// 1) отсечение: вершины без входящих или без исходящих дуг среди оставшихся — отдельные
+//    компоненты, отсечение повторяется волнами, пока такие вершины появляются;
+// 2) прямой и обратный параллельный обход в ширину из опорной вершины с наибольшим
+//    произведением степеней: пересечение достижимых множеств — гигантская компонента;
+// 3) раскраска остатка: цвет вершины — наибольший номер вершины, из которой она достижима,
+//    цвета распространяются по дугам до неподвижной точки; вершина r с цветом r — корень,
+//    её компонента — вершины цвета r, достижимые из r по обратным дугам. Корни обрабатываются
+//    параллельно, затем раскраска повторяется для оставшихся вершин.
+// Номера компонент канонические (см. canonicalComponents).
+vector<int> parallelStrongComponents(const csrGraph& g, const csrGraph& gr, int threads)
+{
+    threads = threadCount(threads);
+    int vertices = g.vertices;
+    vector<atomic<int>> component(vertices);
+    atomic<int> nextId(0);
+    for (auto& c : component)
+        c.store(-1, memory_order_relaxed);
+
+    auto assigned = [&](int v) { return component[v].load(memory_order_relaxed) >= 0; };
+    auto claim = [&](int v, int id)
+    {
+        int expected = -1;
+        return component[v].compare_exchange_strong(expected, id, memory_order_relaxed);
+    };
+
+    // 1. Отсечение
+    vector<atomic<int>> inDegree(vertices), outDegree(vertices);
+    vector<int> all(vertices), frontier;
+    for (int v = 0; v < vertices; v++)
+    {
+        all[v] = v;
+        inDegree[v].store(gr.degree(v), memory_order_relaxed);
+        outDegree[v].store(g.degree(v), memory_order_relaxed);
+    }
+    frontier = parallelExpand(all, threads, [&](int v, vector<int>& next)
+    {
+        if (inDegree[v].load(memory_order_relaxed) == 0 || outDegree[v].load(memory_order_relaxed) == 0)
+            next.push_back(v);
+    });
+    while (!frontier.empty())
+    {
+        frontier = parallelExpand(frontier, threads, [&](int v, vector<int>& next)
         {
-            adjList[edge.to].push_back({ edge.from, edge.weight });
-        }
+            if (!claim(v, nextId++))
+                return;
+            for (arc a : g.neighbors(v))
+                if (inDegree[a.target].fetch_sub(1, memory_order_relaxed) == 1 && !assigned(a.target))
+                    next.push_back(a.target);
+            for (arc a : gr.neighbors(v))
+                if (outDegree[a.target].fetch_sub(1, memory_order_relaxed) == 1 && !assigned(a.target))
+                    next.push_back(a.target);
+        });
     }
 
-    for (int i = 0; i < vertices; ++i) 
+    vector<int> active = parallelExpand(all, threads, [&](int v, vector<int>& next)
+    {
+        if (!assigned(v))
+            next.push_back(v);
+    });
+
+    // 2. Прямой и обратный обход из опорной вершины
+    if (!active.empty())
     {
-        outFile << i << ": ";
-        for (const auto& neighbor : adjList[i])
+        int pivot = active[0];
+        long long best = -1;
+        for (int v : active)
         {
-            if (weighted) {
-                outFile << "(" << neighbor.first << ", " << neighbor.second << ") "; // вершина и вес
+            long long score = (long long)inDegree[v].load(memory_order_relaxed) * outDegree[v].load(memory_order_relaxed);
+            if (score > best)
+            {
+                best = score;
+                pivot = v;
             }
-            else {
-                outFile << neighbor.first << " "; // только вершина
+        }
+
+        // reached: бит 1 — достижима из опорной, бит 2 — опорная достижима из неё
+        vector<atomic<uint8_t>> reached(vertices);
+        for (auto& r : reached)
+            r.store(0, memory_order_relaxed);
+        auto reach = [&](const csrGraph& graph, uint8_t bit)
+        {
+            reached[pivot].fetch_or(bit, memory_order_relaxed);
+            vector<int> level = { pivot };
+            while (!level.empty())
+            {
+                level = parallelExpand(level, threads, [&](int v, vector<int>& next)
+                {
+                    for (arc a : graph.neighbors(v))
+                        if (!assigned(a.target) && !(reached[a.target].fetch_or(bit, memory_order_relaxed) & bit))
+                            next.push_back(a.target);
+                });
             }
+        };
+        reach(g, 1);
+        reach(gr, 2);
+
+        int giant = nextId++;
+        active = parallelExpand(active, threads, [&](int v, vector<int>& next)
+        {
+            if (reached[v].load(memory_order_relaxed) == 3)
+                component[v].store(giant, memory_order_relaxed);
+            else
+                next.push_back(v);
+        });
+    }
+
+    // 3. Раскраска
+    vector<atomic<int>> color(vertices);
+    while (!active.empty())
+    {
+        for (int v : active)
+            color[v].store(v, memory_order_relaxed);
+
+        vector<int> changed = active;
+        while (!changed.empty())
+        {
+            changed = parallelExpand(changed, threads, [&](int v, vector<int>& next)
+            {
+                int c = color[v].load(memory_order_relaxed);
+                for (arc a : g.neighbors(v))
+                    if (!assigned(a.target) && atomicMax(color[a.target], c))
+                        next.push_back(a.target);
+            });
+            sort(changed.begin(), changed.end());
+            changed.erase(unique(changed.begin(), changed.end()), changed.end());
         }
-        outFile << "\n\n";
+
+        vector<int> roots = parallelExpand(active, threads, [&](int v, vector<int>& next)
+        {
+            if (color[v].load(memory_order_relaxed) == v)
+                next.push_back(v);
+        });
+
+        parallelExpand(roots, threads, [&](int root, vector<int>&)
+        {
+            int id = nextId++;
+            vector<int> queue = { root };
+            claim(root, id);
+            for (size_t head = 0; head < queue.size(); head++)
+            {
+                for (arc a : gr.neighbors(queue[head]))
+                {
+                    int w = a.target;
+                    if (color[w].load(memory_order_relaxed) == root && claim(w, id))
+                        queue.push_back(w);
+                }
+            }
+        });
+
+        active = parallelExpand(active, threads, [&](int v, vector<int>& next)
+        {
+            if (!assigned(v))
+                next.push_back(v);
+        });
     }
 
-    outFile.close();
+    vector<int> result(vertices);
+    for (int v = 0; v < vertices; v++)
+        result[v] = component[v].load(memory_order_relaxed);
+    return canonicalComponents(result);
 }
 
-void savedAdjacencyMatrix(vector<Edge>& edgeList, int vertices, int directed, int weighted, string path)
+// Поддержка сильно связных компонент при добавлении дуг. Компоненты хранятся системой
+// непересекающихся множеств вершин, граф компонент — списками дуг между представителями
+// (элементы списков могут ссылаться на уже поглощённые компоненты и разрешаются через find),
+// а топологический порядок компонент — номерами order (алгоритм Пирса — Келли).
+// Дуга u -> v, не нарушающая порядок, только добавляется в списки. Иначе ищутся компоненты,
+// достижимые из v с номером не больше order[u], и компоненты, из которых достижима u,
+// с номером не меньше order[v]: если из v достижима u, их пересечение сливается в одну
+// компоненту, затем номера затронутых компонент переставляются. Работа пропорциональна
+// размеру затронутой области графа компонент, а не всему графу; для больших пакетов
+// она ограничена стоимостью пересчёта (см. insertEdges).
+struct incrementalComponents
 {
-    ofstream outFile(path);
-    if (!outFile)
+    int vertices = 0, directed = 1, count = 0;
+    vector<int> parent, order;
+    vector<vector<int>> out, in;
+    vector<size_t> compactedSize;
+    vector<int> mark, forward, backward;
+    int stamp = 0;
+    size_t arcs = 0, work = 0;
+
+    incrementalComponents() = default;
+
+    incrementalComponents(const csrGraph& g, int isDirected)
+        : vertices(g.vertices), directed(isDirected), parent(g.vertices), order(g.vertices),
+          out(g.vertices), in(g.vertices), compactedSize(g.vertices), mark(g.vertices, 0)
     {
-        cerr << "Ошибка при открытии файла! \n";
-        exit(1);
+        assign(g);
+        arcs = g.arcs();
     }
 
-    vector<vector<int>> adjMatrix(vertices, vector<int>(vertices, 0));
-
-    for (size_t i = 0; i < edgeList.size(); ++i)
+    // Компоненты и граф компонент заново по графу g алгоритмом Пирса
+    void assign(const csrGraph& g)
     {
+        vector<int> componentOf = strongComponents(g);
+        count = 0;
+        for (int id : componentOf)
+            count = max(count, id + 1);
 
-        const Edge& edge = edgeList[i];
+        // Представитель компоненты — её первая вершина; компоненты strongComponents
+        // с большим номером предшествуют в топологическом порядке
+        vector<int> representative(count, -1);
+        for (int v = 0; v < vertices; v++)
+        {
+            int& r = representative[componentOf[v]];
+            if (r < 0)
+            {
+                r = v;
+                order[v] = count - 1 - componentOf[v];
+            }
+            parent[v] = r;
+            out[v].clear();
+            in[v].clear();
+        }
 
-        // Записываем в матрицу смежности
-        adjMatrix[edge.from][edge.to] = weighted ? edge.weight : 1;  // Если граф взвешенный, записываем вес, иначе 1
+        for (int v = 0; v < vertices; v++)
+        {
+            for (arc a : g.neighbors(v))
+            {
+                int from = parent[v], to = parent[a.target];
+                if (from != to)
+                {
+                    out[from].push_back(to);
+                    in[to].push_back(from);
+                }
+            }
+        }
+        for (int v = 0; v < vertices; v++)
+        {
+            compact(out[v], v);
+            compact(in[v], v);
+            compactedSize[v] = out[v].size() + in[v].size();
+        }
+    }
+
+    // Пересчёт по графу компонент с добавленными дугами pending: вершины, не являющиеся
+    // представителями, в этом графе изолированы и затем присоединяются к компоненте представителя
+    void rebuild(const vector<Edge>& pending)
+    {
+        vector<int> representative(vertices);
+        vector<Edge> condensed;
+        for (int v = 0; v < vertices; v++)
+        {
+            representative[v] = find(v);
+            if (representative[v] == v)
+                for (int c : out[v])
+                    condensed.push_back({ v, find(c), 1 });
+        }
+        for (const Edge& e : pending)
+        {
+            condensed.push_back({ representative[e.from], representative[e.to], 1 });
+            if (!directed)
+                condensed.push_back({ representative[e.to], representative[e.from], 1 });
+        }
 
-        // Если граф неориентированный, добавляем обратное ребро
-        if (!directed && edge.from != edge.to)
+        assign(buildCsr(condensed, vertices, 1, 0));
+        count = 0;
+        for (int v = 0; v < vertices; v++)
         {
-            adjMatrix[edge.to][edge.from] = weighted ? edge.weight : 1;
+            if (representative[v] != v)
+                parent[v] = parent[representative[v]];
+            else if (parent[v] == v)
+                count++;
         }
     }
 
-    for (size_t i = 0; i < vertices; i++)
+    int find(int v)
     {
-        for (size_t j = 0; j < vertices; j++)
+        while (parent[v] != v)
         {
-            outFile << adjMatrix[i][j] << " ";
+            parent[v] = parent[parent[v]];
+            v = parent[v];
         }
-        outFile << "\n";
+        return v;
     }
 
-    outFile.close();
-}
+    // Номер компоненты вершины (номер представителя) между пакетами добавлений
+    int component(int v) { return find(v); }
 
-void readData(string path, graphParameters& graph) 
-{
-    ifstream inputFile(path);
-    if (!inputFile) 
+    vector<int> components()
     {
-        cerr << "Ошибка при открытии файла! \n";
-        exit(1);
+        vector<int> componentOf(vertices);
+        for (int v = 0; v < vertices; v++)
+            componentOf[v] = find(v);
+        return canonicalComponents(componentOf);
     }
-    inputFile >> graph.directed >> graph.weighted >> graph.self_loops;
-    inputFile >> graph.Vmin >> graph.Vmax;
-    inputFile >> graph.Emin >> graph.Emax;
-    if (graph.weighted) 
+
+    // Разрешение ссылок на поглощённые компоненты, удаление петель и повторов
+    void compact(vector<int>& list, int self)
     {
-        inputFile >> graph.Wmin >> graph.Wmax;
+        for (int& c : list)
+            c = find(c);
+        sort(list.begin(), list.end());
+        list.erase(unique(list.begin(), list.end()), list.end());
+        list.erase(remove(list.begin(), list.end(), self), list.end());
     }
-    inputFile.close();
-}
 
-void generateGraph(graphParameters& graph, vector<Edge>& edgeList, int& ver) 
-{
-    string matrixFile = "matrix.txt", listFile = "list.txt";
-    srand(time(0));
-    int vertices = graph.Vmin + rand() % (graph.Vmax - graph.Vmin + 1);
-    ver = vertices;
-    int edges = graph.Emin + rand() % (graph.Emax - graph.Emin + 1);
+    // Списки сжимаются, когда вырастают вдвое с прошлого сжатия: сортировка
+    // при каждом слиянии сделала бы добавление дуг к большой компоненте квадратичным
+    void compactIfGrown(int c)
+    {
+        if (out[c].size() + in[c].size() < 2 * compactedSize[c] + 16)
+            return;
+        compact(out[c], c);
+        compact(in[c], c);
+        compactedSize[c] = out[c].size() + in[c].size();
+    }
 
-    set<pair<int, int>> edgeSet;
+    // Добавление пакета дуг. Если обходы пакета просмотрели столько же, сколько стоит
+    // полный пересчёт, остаток пакета добавляется пересчётом по графу компонент
+    void insertEdges(const vector<Edge>& batch)
+    {
+        arcs += batch.size() * (directed ? 1 : 2);
+        work = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            if (16 * work > (size_t)vertices + arcs)
+            {
+                rebuild(vector<Edge>(batch.begin() + i, batch.end()));
+                return;
+            }
+            insertArc(batch[i].from, batch[i].to);
+            if (!directed)
+                insertArc(batch[i].to, batch[i].from);
+        }
+    }
 
-    for (size_t i = 0; i < edges; i++) 
+    void insertArc(int u, int v)
     {
-        int from = rand() % vertices;
-        int to = rand() % vertices;
+        int cu = find(u), cv = find(v);
+        if (cu == cv)
+            return;
+        out[cu].push_back(cv);
+        in[cv].push_back(cu);
+        compactIfGrown(cu);
+        compactIfGrown(cv);
+        if (order[cu] < order[cv])
+            return;
 
-        if (!graph.self_loops && from == to) 
+        // Компоненты, достижимые из cv, не правее cu, и компоненты, из которых достижима cu, не левее cv
+        stamp += 3;
+        forward.clear();
+        backward.clear();
+        bool cycle = search(cv, out, forward, stamp, order[cu], true, cu);
+        search(cu, in, backward, stamp + 1, order[cv], false, -1);
+
+        vector<int> positions;
+        for (int c : forward)
+            positions.push_back(order[c]);
+        for (int c : backward)
+            positions.push_back(order[c]);
+        sort(positions.begin(), positions.end());
+        positions.erase(unique(positions.begin(), positions.end()), positions.end());
+
+        auto byOrder = [&](int a, int b) { return order[a] < order[b]; };
+        sort(forward.begin(), forward.end(), byOrder);
+        sort(backward.begin(), backward.end(), byOrder);
+
+        // Компоненты backward занимают первые освободившиеся номера, forward — последние:
+        // каждая из них сдвигается только в сторону, где нет её соседей вне области
+        vector<int> sequence;
+        size_t tail = forward.size();
+        if (cycle)
         {
-            i--;
-            continue;
-        }
+            // Общие компоненты двух областей лежат на цикле через новую дугу и сливаются
+            // в одну; пометка stamp + 1 у вершины из forward означает, что она есть и в backward,
+            // такие вершины перемечаются stamp + 2. Представителем становится компонента
+            // с самыми длинными списками, остальные списки дописываются к её спискам
+            vector<int> merged;
+            int root = cu;
+            for (int c : forward)
+            {
+                if (mark[c] == stamp + 1)
+                {
+                    merged.push_back(c);
+                    if (out[c].size() + in[c].size() > out[root].size() + in[root].size())
+                        root = c;
+                }
+            }
+            for (int c : merged)
+                mark[c] = stamp + 2;
+            for (int c : backward)
+                if (mark[c] != stamp + 2)
+                    sequence.push_back(c);
+            sequence.push_back(root);
+            tail = 0;
+            for (int c : forward)
+            {
+                if (mark[c] != stamp + 2)
+                {
+                    sequence.push_back(c);
+                    tail++;
+                }
+            }
 
-        if (!graph.directed && from > to) 
+            for (int c : merged)
+            {
+                if (c == root)
+                    continue;
+                parent[c] = root;
+                out[root].insert(out[root].end(), out[c].begin(), out[c].end());
+                in[root].insert(in[root].end(), in[c].begin(), in[c].end());
+                vector<int>().swap(out[c]);
+                vector<int>().swap(in[c]);
+                count--;
+            }
+            compactIfGrown(root);
+        }
+        else
         {
-            swap(from, to);
+            sequence = backward;
+            sequence.insert(sequence.end(), forward.begin(), forward.end());
         }
 
-        if (edgeSet.count({ from, to })) 
+        size_t head = sequence.size() - tail;
+        for (size_t i = 0; i < head; i++)
+            order[sequence[i]] = positions[i];
+        for (size_t i = 0; i < tail; i++)
+            order[sequence[head + i]] = positions[positions.size() - tail + i];
+    }
+
+    // Обход графа компонент из start по спискам lists в пределах границы порядка;
+    // forwardSearch — обход вправо до limit включительно, иначе влево до limit.
+    // Пометка tag ставится каждой посещённой компоненте; возвращает true, если встретилась target
+    bool search(int start, vector<vector<int>>& lists, vector<int>& visited, int tag, int limit,
+        bool forwardSearch, int target)
+    {
+        bool found = false;
+        vector<int> st = { start };
+        mark[start] = tag;
+        visited.push_back(start);
+        while (!st.empty())
         {
-            i--;
-            continue;
+            int c = st.back();
+            st.pop_back();
+            if (c == target)
+            {
+                // все преемники target правее границы
+                found = true;
+                continue;
+            }
+            work += lists[c].size() + 1;
+            for (int& next : lists[c])
+            {
+                next = find(next);
+                if (next == c || mark[next] == tag)
+                    continue;
+                if (forwardSearch ? order[next] > limit : order[next] < limit)
+                    continue;
+                mark[next] = tag;
+                visited.push_back(next);
+                st.push_back(next);
+            }
         }
+        return found;
+    }
+};
+
+// Сравнение добавления дуг с полным пересчётом: граф строится по всем дугам g, кроме
+// insertions случайно выбранных, затем они добавляются пакетами по batchSize. Полный
+// пересчёт (построение списков смежности и алгоритм Пирса) замеряется после части пакетов
+void benchmarkInsertions(const csrGraph& g, size_t insertions, size_t batchSize)
+{
+    vector<Edge> arcs;
+    for (int v = 0; v < g.vertices; v++)
+        for (arc a : g.neighbors(v))
+            arcs.push_back({ v, (int)a.target, 1 });
+    shuffle(arcs.begin(), arcs.end(), mt19937(1));
+
+    insertions = min(insertions, arcs.size());
+    batchSize = max<size_t>(1, batchSize);
+    vector<Edge> prefix(arcs.begin(), arcs.end() - insertions);
 
-        edgeSet.insert({ from, to });
-        int weight = 0;
-        if (graph.weighted) 
+    auto startTime = chrono::steady_clock::now();
+    incrementalComponents components(buildCsr(prefix, g.vertices, 1, 0), 1);
+    double buildTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    size_t batches = (insertions + batchSize - 1) / batchSize, measureEvery = max<size_t>(1, batches / 20);
+    size_t measured = 0;
+    double incrementalTime = 0, fullTime = 0;
+    for (size_t b = 0; b < batches; b++)
+    {
+        auto first = arcs.end() - insertions + b * batchSize;
+        vector<Edge> batch(first, first + min(batchSize, insertions - b * batchSize));
+
+        startTime = chrono::steady_clock::now();
+        components.insertEdges(batch);
+        incrementalTime += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        prefix.insert(prefix.end(), batch.begin(), batch.end());
+        if (b % measureEvery == 0)
         {
-            weight = graph.Wmin + rand() % (graph.Wmax - graph.Wmin + 1);
+            startTime = chrono::steady_clock::now();
+            strongComponents(buildCsr(prefix, g.vertices, 1, 0));
+            fullTime += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+            measured++;
         }
-        edgeList.push_back({ from, to, weight });
     }
 
-    savedAdjacencyMatrix(edgeList, vertices, graph.directed, graph.weighted, matrixFile);
+    bool same = canonicalComponents(strongComponents(buildCsr(prefix, g.vertices, 1, 0))) == components.components();
+    cout << "\nНачальное построение по " << arcs.size() - insertions << " дугам: " << buildTime << " с\n"
+         << "Добавление " << insertions << " дуг пакетами по " << batchSize << ": " << incrementalTime / batches * 1e3
+         << " мс на пакет\nПолный пересчёт: " << (measured ? fullTime / measured * 1e3 : 0) << " мс на пакет\n"
+         << (same ? "Компоненты совпадают\n" : "КОМПОНЕНТЫ РАЗЛИЧАЮТСЯ\n");
+}
 
-    savedAdjacencyList(edgeList, vertices, graph.directed, graph.weighted, listFile);
+void printComponent(const vector<int>& component)
+{
+    cout << "{ ";
+    for (int node : component) 
+    {
+        cout << permutation.original(node) << " ";
+    }
+    cout << "}\n";
 }
 
-void buildAdjacencyLists(int vertices, const vector<Edge>& edgeList, vector<vector<int>>& g, vector<vector<int>>& gr, int directed) 
+// Вывод компонент по убыванию номера: для strongComponents это порядок от истоков графа
+// компонент к стокам, как у алгоритма Косарайю
+void printComponents(const vector<int>& componentOf)
 {
-    g.assign(vertices, vector<int>());
-    gr.assign(vertices, vector<int>());
+    int count = 0;
+    for (int id : componentOf)
+        count = max(count, id + 1);
 
-    for (const auto& edge : edgeList) 
+    vector<int> first(count + 1, 0), members(componentOf.size());
+    for (int id : componentOf)
+        first[id + 1]++;
+    for (int id = 0; id < count; id++)
+        first[id + 1] += first[id];
+    vector<int> cursor(first.begin(), first.end() - 1);
+    for (size_t v = 0; v < componentOf.size(); v++)
+        members[cursor[componentOf[v]]++] = (int)v;
+
+    cout << "\nСильно связные компоненты:\n";
+    vector<int> component;
+    for (int id = count - 1; id >= 0; id--)
     {
-        g[edge.from].push_back(edge.to);
-        gr[edge.to].push_back(edge.from);
-        if (!directed) 
-        {
-            g[edge.to].push_back(edge.from);
-            gr[edge.from].push_back(edge.to);
-        }
+        component.assign(members.begin() + first[id], members.begin() + first[id + 1]);
+        printComponent(component);
     }
 }
 
-void dfs1(int v, const vector<vector<int>>& g, vector<bool>& used, vector<int>& order) 
+// Система непересекающихся множеств для нескольких потоков: корень с большим номером
+// подвешивается к корню с меньшим сравнением с обменом, поиск сокращает пути через
+// деда (гонки при сокращении безопасны — записывается только более близкий предок)
+struct concurrentUnionFind
 {
-    used[v] = true;
-    for (int to : g[v]) 
+    vector<atomic<int>> parent;
+
+    explicit concurrentUnionFind(int vertices) : parent(vertices)
     {
-        if (!used[to]) 
+        for (int v = 0; v < vertices; v++)
+            parent[v].store(v, memory_order_relaxed);
+    }
+
+    int find(int v)
+    {
+        while (true)
         {
-            dfs1(to, g, used, order);
+            int p = parent[v].load(memory_order_relaxed);
+            if (p == v)
+                return v;
+            int grand = parent[p].load(memory_order_relaxed);
+            if (grand != p)
+                parent[v].compare_exchange_weak(p, grand, memory_order_relaxed);
+            v = p;
         }
     }
-    order.push_back(v);
+
+    void unite(int a, int b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a > b)
+                swap(a, b);
+            int expected = b;
+            if (parent[b].compare_exchange_strong(expected, a, memory_order_relaxed))
+                return;
+        }
+    }
+};
+
+// Номера компонент связности по возрастанию наименьшей вершины, отсчитываемые от конца:
+// printComponents выводит их начиная с компоненты вершины 0
+vector<int> componentsFromRoots(concurrentUnionFind& sets, int vertices, int threads)
+{
+    vector<int> root(vertices);
+    parallelFor(0, vertices, threads, [&](size_t v) { root[v] = sets.find((int)v); });
+
+    // Корень — наименьшая вершина своей компоненты, поэтому компоненты нумеруются при первом же корне
+    vector<int> componentOf(vertices);
+    int count = 0;
+    for (int v = 0; v < vertices; v++)
+        componentOf[v] = root[v] == v ? count++ : componentOf[root[v]];
+    for (int& id : componentOf)
+        id = count - 1 - id;
+    return componentOf;
 }
 
-void dfs2(int v, const vector<vector<int>>& gr, vector<bool>& used, vector<int>& component) 
+// Компоненты связности неориентированного графа прямо по списку рёбер: рёбра
+// объединяются участками в threads потоках, списки смежности не строятся
+vector<int> connectedComponents(const vector<Edge>& edgeList, int vertices, int threads)
 {
-    used[v] = true;
-    component.push_back(v);
-    for (int to : gr[v]) 
+    concurrentUnionFind sets(vertices);
+    size_t parts = min<size_t>((size_t)threadCount(threads) * 4, (edgeList.size() + 65535) / 65536);
+    parallelFor(0, max<size_t>(parts, 1), threads, [&](size_t part)
     {
-        if (!used[to]) 
+        size_t first = edgeList.size() * part / max<size_t>(parts, 1), last = edgeList.size() * (part + 1) / max<size_t>(parts, 1);
+        for (size_t i = first; i < last; i++)
+            sets.unite(edgeList[i].from, edgeList[i].to);
+    });
+    return componentsFromRoots(sets, vertices, threads);
+}
+
+// То же для графа, уже открытого из файла: каждое ребро хранится двумя дугами, берётся одна
+template <typename Graph>
+vector<int> connectedComponents(const Graph& g, int threads)
+{
+    concurrentUnionFind sets(g.vertices);
+    size_t parts = min<size_t>((size_t)threadCount(threads) * 4, ((size_t)g.vertices + 4095) / 4096);
+    parallelFor(0, max<size_t>(parts, 1), threads, [&](size_t part)
+    {
+        int first = (int)((size_t)g.vertices * part / max<size_t>(parts, 1));
+        int last = (int)((size_t)g.vertices * (part + 1) / max<size_t>(parts, 1));
+        for (int v = first; v < last; v++)
+            for (arc a : g.neighbors(v))
+                if ((int)a.target < v)
+                    sets.unite(v, a.target);
+    });
+    return componentsFromRoots(sets, g.vertices, threads);
+}
+
+// Граф компонент: компоненты перенумерованы в топологическом порядке (дуги идут только
+// от меньшего номера к большему), повторяющиеся дуги между компонентами удалены
+struct condensationGraph
+{
+    int count = 0;
+    vector<int> componentOf; // номер компоненты вершины в топологическом порядке
+    vector<int> position;    // номер компоненты с исходным номером id в топологическом порядке
+    csrGraph dag;
+};
+
+// Дуги между компонентами в виде отсортированных ключей from << 32 | to без повторов
+vector<uint64_t> componentArcs(const vector<uint64_t>& keys, int threads)
+{
+    vector<uint64_t> sorted = keys;
+    if (threadCount(threads) == 1 || sorted.size() < (1u << 16))
+    {
+        sort(sorted.begin(), sorted.end());
+    }
+    else
+    {
+        // Сортировка участков в потоках и попарное слияние
+        size_t parts = threadCount(threads);
+        vector<size_t> bounds(parts + 1);
+        for (size_t i = 0; i <= parts; i++)
+            bounds[i] = sorted.size() * i / parts;
+        parallelFor(0, parts, threads, [&](size_t part)
         {
-            dfs2(to, gr, used, component);
-        }
+            sort(sorted.begin() + bounds[part], sorted.begin() + bounds[part + 1]);
+        });
+        for (size_t width = 1; width < parts; width *= 2)
+            for (size_t i = 0; i + width < parts; i += 2 * width)
+                inplace_merge(sorted.begin() + bounds[i], sorted.begin() + bounds[i + width],
+                    sorted.begin() + bounds[min(parts, i + 2 * width)]);
     }
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    return sorted;
 }
 
-void findStronglyConnectedComponents(int vertices, const vector<vector<int>>& g, const vector<vector<int>>& gr) 
+csrGraph arcsToCsr(const vector<uint64_t>& keys, int vertices)
 {
-    vector<bool> used(vertices, false);
-    vector<int> order, component;
+    auto buffers = make_shared<csrBuffers>();
+    buffers->offsets.assign(vertices + 1, 0);
+    buffers->targets.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        buffers->offsets[(keys[i] >> 32) + 1]++;
+        buffers->targets[i] = (uint32_t)keys[i];
+    }
+    for (int v = 0; v < vertices; v++)
+        buffers->offsets[v + 1] += buffers->offsets[v];
+    return makeCsr(vertices, 0, buffers);
+}
 
-    // Первый проход — прямой граф
-    for (int i = 0; i < vertices; ++i)
+// Граф компонент по разбиению componentOf с любой нумерацией компонент;
+// топологический порядок — алгоритм Кана по графу компонент
+template <typename Graph>
+condensationGraph buildCondensation(const Graph& g, const vector<int>& componentOf, int threads)
+{
+    condensationGraph c;
+    for (int id : componentOf)
+        c.count = max(c.count, id + 1);
+
+    auto collect = [&](const vector<int>& id)
     {
-        if (!used[i]) 
+        vector<uint64_t> keys;
+        for (int v = 0; v < g.vertices; v++)
+            for (arc a : g.neighbors(v))
+                if (id[v] != id[a.target])
+                    keys.push_back((uint64_t)id[v] << 32 | (uint32_t)id[a.target]);
+        return componentArcs(keys, threads);
+    };
+
+    vector<uint64_t> keys = collect(componentOf);
+    csrGraph byId = arcsToCsr(keys, c.count);
+
+    vector<int> inDegree(c.count, 0), queue;
+    for (uint64_t key : keys)
+        inDegree[(uint32_t)key]++;
+    for (int id = 0; id < c.count; id++)
+        if (inDegree[id] == 0)
+            queue.push_back(id);
+    for (size_t head = 0; head < queue.size(); head++)
+        for (arc a : byId.neighbors(queue[head]))
+            if (--inDegree[a.target] == 0)
+                queue.push_back(a.target);
+
+    c.position.resize(c.count);
+    for (int i = 0; i < c.count; i++)
+        c.position[queue[i]] = i;
+    c.componentOf.resize(componentOf.size());
+    for (size_t v = 0; v < componentOf.size(); v++)
+        c.componentOf[v] = c.position[componentOf[v]];
+
+    for (uint64_t& key : keys)
+        key = (uint64_t)c.position[key >> 32] << 32 | (uint32_t)c.position[(uint32_t)key];
+    c.dag = arcsToCsr(componentArcs(keys, threads), c.count);
+    return c;
+}
+
+// Индекс достижимости по графу компонент.
+// Интервальные метки: обход в глубину по графу компонент нумерует компоненты в порядке
+// завершения (post); поддерево обхода занимает отрезок [treeLow, post], а low — наименьший
+// post среди всех достижимых компонент. Если u достигает v, то post[v] <= post[u] и
+// low[u] <= low[v] — большинство отрицательных ответов получается сравнением меток;
+// v в отрезке поддерева u — положительный ответ.
+// Транзитивное замыкание хранится битами по 64 компоненты-цели: маска компоненты для
+// блока целей — объединение масок её преемников, поэтому блок считается одним проходом
+// по дугам в обратном топологическом порядке. Полное замыкание строится, если умещается
+// в closureLimit байт; иначе для оставшихся запросов — поиск в глубину с отсечениями
+// по меткам, а пакет запросов (reachableBatch) считает маски только для нужных блоков.
+struct reachabilityIndex
+{
+    condensationGraph c;
+    vector<int> post, treeLow, low;
+    size_t words = 0;
+    vector<uint64_t> closure;
+    vector<int> mark;
+    int stamp = 0;
+
+    reachabilityIndex(condensationGraph condensation, int threads, size_t closureLimit = 256u << 20)
+        : c(move(condensation)), post(c.count), treeLow(c.count), low(c.count), mark(c.count, 0)
+    {
+        // Итеративный обход в глубину от компонент в топологическом порядке
+        vector<char> visited(c.count, 0);
+        vector<pair<int, uint32_t>> st;
+        int counter = 0;
+        for (int start = 0; start < c.count; start++)
+        {
+            if (visited[start])
+                continue;
+            visited[start] = 1;
+            treeLow[start] = counter;
+            st.push_back({ start, c.dag.begin(start) });
+            while (!st.empty())
+            {
+                auto& [x, next] = st.back();
+                if (next < c.dag.end(x))
+                {
+                    int y = c.dag.targets[next++];
+                    if (!visited[y])
+                    {
+                        visited[y] = 1;
+                        treeLow[y] = counter;
+                        st.push_back({ y, c.dag.begin(y) });
+                    }
+                }
+                else
+                {
+                    post[x] = counter++;
+                    st.pop_back();
+                }
+            }
+        }
+        for (int x = c.count - 1; x >= 0; x--)
         {
-            dfs1(i, g, used, order);
+            low[x] = treeLow[x];
+            for (arc a : c.dag.neighbors(x))
+                low[x] = min(low[x], low[a.target]);
+        }
+
+        size_t blocks = (c.count + 63) / 64;
+        if (blocks * c.count * sizeof(uint64_t) <= closureLimit)
+        {
+            words = blocks;
+            closure.assign(words * c.count, 0);
+            parallelFor(0, blocks, threads, [&](size_t block)
+            {
+                vector<uint64_t> mask;
+                blockMasks(block, mask);
+                for (size_t x = 0; x < mask.size(); x++)
+                    closure[x * words + block] = mask[x];
+            });
         }
     }
 
-    // Второй проход — транспонированный граф
-    used.assign(vertices, false);
-    cout << "\nСильно связные компоненты:\n";
-    for (int i = vertices - 1; i >= 0; --i)
+    // Маски достижимости блока целей [64 * block, 64 * block + 64) для компонент левее его конца
+    void blockMasks(size_t block, vector<uint64_t>& mask) const
+    {
+        int first = (int)(block * 64), last = min(c.count, first + 64);
+        mask.assign(last, 0);
+        for (int x = last - 1; x >= 0; x--)
+        {
+            uint64_t m = x >= first ? 1ull << (x - first) : 0;
+            for (arc a : c.dag.neighbors(x))
+                if ((int)a.target < last)
+                    m |= mask[a.target];
+            mask[x] = m;
+        }
+    }
+
+    // Ответ по меткам: 1 — достижима, 0 — нет, -1 — неизвестно
+    int byLabels(int x, int y) const
     {
-        int v = order[i];
-        if (!used[v])
+        if (x == y)
+            return 1;
+        if (x > y || post[y] > post[x] || low[y] < low[x])
+            return 0;
+        if (treeLow[x] <= post[y])
+            return 1;
+        return -1;
+    }
+
+    // Поиск в глубину, отсекающий компоненты, из которых y заведомо недостижима;
+    // mark и stamp — пометки посещённых компонент, свои у каждого потока
+    bool search(int x, int y, vector<int>& mark, int& stamp) const
+    {
+        stamp++;
+        vector<int> st = { x };
+        mark[x] = stamp;
+        while (!st.empty())
         {
-            dfs2(v, gr, used, component);
-            cout << "{ ";
-            for (int node : component) 
+            int z = st.back();
+            st.pop_back();
+            for (arc a : c.dag.neighbors(z))
             {
-                cout << node << " ";
+                int w = a.target;
+                if (mark[w] == stamp)
+                    continue;
+                mark[w] = stamp;
+                int known = byLabels(w, y);
+                if (known == 1)
+                    return true;
+                if (known < 0)
+                    st.push_back(w);
             }
-            cout << "}\n";
-            component.clear();
         }
+        return false;
+    }
+
+    bool reachable(int u, int v)
+    {
+        int x = c.componentOf[u], y = c.componentOf[v];
+        int answer = byLabels(x, y);
+        if (answer >= 0)
+            return answer;
+        if (words)
+            return (closure[(size_t)x * words + y / 64] >> (y % 64)) & 1;
+        return search(x, y, mark, stamp);
     }
+
+    // Пакет запросов: неразрешённые метками запросы группируются по блоку цели; маски
+    // блока считаются один раз, если их подсчёт (проход по компонентам левее конца блока)
+    // обходится не дороже 256 шагов на запрос, иначе каждый запрос решается поиском
+    vector<char> reachableBatch(const vector<pair<int, int>>& queries, int threads) const
+    {
+        vector<char> answers(queries.size());
+        vector<vector<size_t>> byBlock((c.count + 63) / 64);
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            int x = c.componentOf[queries[i].first], y = c.componentOf[queries[i].second];
+            int answer = byLabels(x, y);
+            if (answer < 0 && words)
+                answer = (closure[(size_t)x * words + y / 64] >> (y % 64)) & 1;
+            if (answer >= 0)
+                answers[i] = (char)answer;
+            else
+                byBlock[y / 64].push_back(i);
+        }
+
+        size_t parts = min<size_t>((size_t)threadCount(threads) * 4, byBlock.size());
+        parallelFor(0, parts, threads, [&](size_t part)
+        {
+            vector<uint64_t> mask;
+            vector<int> visited;
+            int visitedStamp = 0;
+            for (size_t block = byBlock.size() * part / parts; block < byBlock.size() * (part + 1) / parts; block++)
+            {
+                if (byBlock[block].size() * 256 >= min<size_t>(c.count, block * 64 + 64))
+                {
+                    blockMasks(block, mask);
+                    for (size_t i : byBlock[block])
+                    {
+                        int x = c.componentOf[queries[i].first], y = c.componentOf[queries[i].second];
+                        answers[i] = (char)((mask[x] >> (y % 64)) & 1);
+                    }
+                    continue;
+                }
+                for (size_t i : byBlock[block])
+                {
+                    if (visited.empty())
+                        visited.assign(c.count, 0);
+                    answers[i] = (char)search(c.componentOf[queries[i].first], c.componentOf[queries[i].second],
+                        visited, visitedStamp);
+                }
+            }
+        });
+        return answers;
+    }
+};
+
+// Достижимость обходом в ширину — для проверки индекса
+template <typename Graph>
+bool reachableBySearch(const Graph& g, int u, int v)
+{
+    vector<char> visited(g.vertices, 0);
+    vector<int> queue = { u };
+    visited[u] = 1;
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        if (queue[head] == v)
+            return true;
+        for (arc a : g.neighbors(queue[head]))
+            if (!visited[a.target])
+            {
+                visited[a.target] = 1;
+                queue.push_back(a.target);
+            }
+    }
+    return false;
+}
+
+// Построение индекса и ответы на queries случайных запросов: по одному, пакетом
+// и проверка части ответов обходом графа
+template <typename Graph>
+void benchmarkReachability(const Graph& g, const vector<int>& componentOf, size_t queries, int threads)
+{
+    auto startTime = chrono::steady_clock::now();
+    condensationGraph condensation = buildCondensation(g, componentOf, threads);
+    double condensationTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "\nГраф компонент: " << condensation.count << " компонент, " << condensation.dag.arcs()
+         << " дуг, построен за " << condensationTime << " с\n";
+
+    startTime = chrono::steady_clock::now();
+    reachabilityIndex index(move(condensation), threads);
+    double indexTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "Индекс достижимости: " << indexTime << " с, транзитивное замыкание "
+         << (index.words ? to_string(index.closure.size() * 8 / 1024 / 1024) + " МБ" : string("не построено")) << "\n";
+
+    mt19937 rng(1);
+    vector<pair<int, int>> pairs(queries);
+    for (auto& q : pairs)
+        q = { (int)(rng() % g.vertices), (int)(rng() % g.vertices) };
+
+    startTime = chrono::steady_clock::now();
+    vector<char> single(queries);
+    for (size_t i = 0; i < queries; i++)
+        single[i] = index.reachable(pairs[i].first, pairs[i].second);
+    double singleTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    startTime = chrono::steady_clock::now();
+    vector<char> batch = index.reachableBatch(pairs, threads);
+    double batchTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    size_t checked = min<size_t>(queries, 200), wrong = 0, positive = 0;
+    startTime = chrono::steady_clock::now();
+    for (size_t i = 0; i < checked; i++)
+        wrong += reachableBySearch(g, pairs[i].first, pairs[i].second) != (bool)single[i];
+    double searchTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    for (char r : single)
+        positive += r;
+
+    cout << queries << " запросов, достижимо " << positive << ": по одному " << singleTime / max<size_t>(queries, 1) * 1e9
+         << " нс на запрос, пакетом " << batchTime / max<size_t>(queries, 1) * 1e9 << " нс, обход графа "
+         << searchTime / max<size_t>(checked, 1) * 1e9 << " нс\n"
+         << (wrong == 0 && single == batch ? "Ответы совпадают с обходом графа\n" : "ОТВЕТЫ РАЗЛИЧАЮТСЯ\n");
 }
 
 int main() 
 {
     setlocale(LC_ALL, "Russian");
 
-    string inputfilePath = "input.txt";
+    string inputfilePath = "input.txt", binaryFilePath = "graph.bin", compressedFilePath = "graph.cbin";
     graphParameters graph;
-    int vertices;
+    int vertices, source, answer, order, algorithm = 0;
     vector<Edge> edgeList;
+    future<void> saving;
+    csrGraph g;
+    bitMatrix m;
+    compressedGraph cg;
+    bool dense = false, compressed = false;
+
+    // Граф генерируется по input.txt или открывается из двоичного файла без разбора и копирования
+    cout << "Источник графа (0 - генерация по input.txt, 1 - файл graph.bin, 2 - сжатый файл graph.cbin): ";
+    cin >> source;
+
+    if (source == 2)
+    {
+        cg = openCompressedGraph(compressedFilePath, graph.directed);
+        vertices = cg.vertices;
+        compressed = true;
+    }
+    else if (source)
+    {
+        g = openBinaryGraph(binaryFilePath, graph.directed);
+        vertices = g.vertices;
+    }
+    else
+    {
+        // Считывание параметров графа
+        readData(inputfilePath, graph);
+
+        generateGraph(graph, edgeList, vertices);
+
+        // Запись строит списки смежности и матрицу V x V, поэтому она необязательна; файлы
+        // пишутся в фоне и не задерживают алгоритмы
+        cout << "\nСохранить граф в list.txt, matrix.txt и graph.bin? (0 - нет, 1 - да): ";
+        cin >> answer;
+        if (answer)
+            saving = saveGraphAsync(edgeList, vertices, graph);
+    }
 
-    // Считывание параметров графа
-    readData(inputfilePath, graph);
+    // В неориентированном графе сильно связные компоненты — обычные компоненты связности:
+    // они находятся объединением концов рёбер без построения списков смежности и матриц
+    if (!graph.directed)
+    {
+        vector<int> componentOf;
+        if (source == 2)
+            componentOf = connectedComponents(cg, graph.threads);
+        else if (source)
+            componentOf = connectedComponents(g, graph.threads);
+        else
+            componentOf = connectedComponents(edgeList, vertices, graph.threads);
+        printComponents(componentOf);
 
-    // Генерация графа
-    generateGraph(graph, edgeList, vertices);
+        if (saving.valid())
+            saving.wait();
+        return 0;
+    }
 
-    // Создание списков смежности для прямого и транспонированного графа
-    vector<vector<int>> g, gr;
-    buildAdjacencyLists(vertices, edgeList, g, gr, graph.directed);
+    if (!source)
+    {
+        // Плотный граф хранится битовой матрицей: она занимает V² / 8 байт, а списки смежности —
+        // 4 байта на дугу. Алгоритму Пирса нужен только прямой граф, соседи вершины — единичные
+        // биты её строки
+        dense = (uint64_t)vertices * vertices < 32 * (uint64_t)edgeList.size();
+
+        if (dense)
+            m = buildBitMatrix(edgeList, vertices, graph.directed);
+        else
+            g = buildCsr(edgeList, vertices, graph.directed, 0, graph.threads);
+    }
+
+    if (!dense && !compressed)
+    {
+        // Перенумерация вершин делает обращения к соседям более локальными
+        cout << "\nПорядок вершин (0 - исходный, 1 - по убыванию степени, 2 - RCM, 3 - BFS, 4 - сравнить все): ";
+        cin >> order;
+        if (order == 4)
+        {
+            benchmarkOrders(g, graph.threads, [&](const csrGraph& pg, const vertexPermutation&)
+            {
+                strongComponents(pg);
+            });
+        }
+        else if (order != originalOrder)
+        {
+            permutation = computeOrder(g, order);
+            g = permuteGraph(g, permutation, graph.threads);
+        }
+
+        // Для очень больших графов списки смежности можно сжать; сжатый граф сохраняется в graph.cbin
+        cout << "\nСжать списки смежности? (0 - нет, 1 - да): ";
+        cin >> answer;
+        if (answer)
+        {
+            cg = compressGraph(g, graph.threads);
+            cout << "Списки смежности: " << (g.arcs() + (size_t)vertices + 1) * 4 / 1024.0 / 1024.0
+                 << " МБ, сжатые: " << cg.memoryBytes() / 1024.0 / 1024.0 << " МБ\n";
+            if (permutation.newId.empty()) // в файле — только граф в исходных номерах
+                savedCompressedGraph(cg, graph.directed, compressedFilePath);
+            g = csrGraph();
+            compressed = true;
+        }
+    }
 
     // Нахождение и вывод сильно связных компонент
-    findStronglyConnectedComponents(vertices, g, gr);
+    if (!compressed)
+    {
+        cout << "Алгоритм (0 - последовательный, 1 - параллельный, 2 - сравнить оба, "
+             << "3 - сравнить добавление дуг с пересчётом): ";
+        cin >> algorithm;
+        if (algorithm && dense)
+        {
+            // Параллельный алгоритм и добавление дуг работают со списками смежности
+            g = buildCsr(edgeList, vertices, graph.directed, 0, graph.threads);
+            m = bitMatrix();
+            dense = false;
+        }
+        if (algorithm == 3)
+        {
+            // 1000 дуг по одной и пакетами по 100, 100000 дуг пакетами по 10000, не больше половины дуг
+            for (size_t batchSize : { 1, 100, 10000 })
+                benchmarkInsertions(g, min<size_t>(max<size_t>(1000, 10 * batchSize), g.arcs() / 2), batchSize);
+            algorithm = 0;
+        }
+    }
+
+    vector<int> componentOf;
+    if (compressed)
+        componentOf = strongComponents(cg);
+    else if (dense)
+        componentOf = strongComponents(m);
+    else if (algorithm == 0)
+        componentOf = strongComponents(g);
+    else
+    {
+        csrGraph gr = g.transposed();
+        auto startTime = chrono::steady_clock::now();
+        componentOf = parallelStrongComponents(g, gr, graph.threads);
+        double parallelTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        if (algorithm == 2)
+        {
+            startTime = chrono::steady_clock::now();
+            vector<int> sequential = canonicalComponents(strongComponents(g));
+            double sequentialTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+            cout << "Последовательный: " << sequentialTime << " с, параллельный (" << threadCount(graph.threads)
+                 << " потоков): " << parallelTime << " с, ускорение " << sequentialTime / parallelTime
+                 << (sequential == componentOf ? ", компоненты совпадают\n" : ", КОМПОНЕНТЫ РАЗЛИЧАЮТСЯ\n");
+        }
+    }
+
+    printComponents(componentOf);
+
+    // Запросы «достижима ли v из u» через граф компонент и индекс достижимости
+    size_t queries;
+    cout << "\nЧисло случайных запросов достижимости (0 - пропустить): ";
+    cin >> queries;
+    if (queries)
+    {
+        if (compressed)
+            benchmarkReachability(cg, componentOf, queries, graph.threads);
+        else if (dense)
+            benchmarkReachability(m, componentOf, queries, graph.threads);
+        else
+            benchmarkReachability(g, componentOf, queries, graph.threads);
+    }
+
+    if (saving.valid())
+        saving.wait();
 
     return 0;
 }